@@ -0,0 +1,219 @@
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+#include <new>
+#include "AllocationTracker.h"
+
+using namespace std;
+
+atomic<bool> AllocationTracker::mEnabled(false);
+
+// Innermost allocation scope on the calling thread, or NULL outside all scopes
+static thread_local const char* sScope = NULL;
+
+// Name reported for allocations made outside any scope
+static const char* UNSCOPED = "(unscoped)";
+
+// PRIVATE INSTANCE CONSTRUCTORS //////////////////////////////////////////////
+
+/** Constructor. */
+AllocationTracker::AllocationTracker(void)
+{
+	for (uint i = 0; i < MAX_SCOPES; i++) {
+		mCounters[i].scope = NULL;
+		mCounters[i].allocations = 0;
+		mCounters[i].bytes = 0;
+	}
+	// The first counter is kept for unscoped allocations
+	mCounters[0].scope = UNSCOPED;
+
+	// Reserve up front so reporting a frame never allocates
+	mLastFrame.allocations = 0;
+	mLastFrame.bytes = 0;
+	mLastFrame.scopes.reserve(MAX_SCOPES);
+}
+
+// PUBLIC STATIC METHODS //////////////////////////////////////////////////////
+
+/** Returns true if this build counts allocations, i.e. TRACK_ALLOCATIONS
+	was defined when this file was compiled. */
+bool AllocationTracker::IsAvailable(void)
+{
+#ifdef TRACK_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/** Set the calling thread's allocation scope, returning the previous one. */
+const char* AllocationTracker::SetScope(const char* name)
+{
+	const char* previous = sScope;
+	sScope = name;
+	return previous;
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Turn counting on or off. Counts since the last frame are discarded. */
+void AllocationTracker::SetEnabled(bool enabled)
+{
+	mEnabled.store(enabled, memory_order_relaxed);
+	for (uint i = 0; i < MAX_SCOPES; i++) {
+		mCounters[i].allocations = 0;
+		mCounters[i].bytes = 0;
+	}
+}
+
+/** Finish counting the current frame and start counting the next one.
+	The finished frame is available from GetLastFrame(). */
+void AllocationTracker::NewFrame(void)
+{
+	if (!IsEnabled()) return;
+
+	mLastFrame.allocations = 0;
+	mLastFrame.bytes = 0;
+	mLastFrame.scopes.clear();
+	for (uint i = 0; i < MAX_SCOPES; i++) {
+		uint allocations = mCounters[i].allocations.exchange(0);
+		size_t bytes = mCounters[i].bytes.exchange(0);
+		if (allocations == 0) continue;
+
+		AllocationCount count;
+		count.scope = mCounters[i].scope;
+		count.allocations = allocations;
+		count.bytes = bytes;
+		mLastFrame.scopes.push_back(count);
+		mLastFrame.allocations += allocations;
+		mLastFrame.bytes += bytes;
+	}
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Count an allocation against the calling thread's scope. This is called
+	from operator new, so it must not allocate. */
+void AllocationTracker::Record(size_t bytes)
+{
+	ScopeCounter* counter = &mCounters[0];
+	const char* scope = sScope;
+	if (scope != NULL) {
+		// Scope names are string literals, so look them up by address
+		uint start = (uint)(((uintptr_t)scope >> 3) % (MAX_SCOPES - 1));
+		for (uint n = 0; n < MAX_SCOPES - 1; n++) {
+			ScopeCounter* candidate = &mCounters[1 + (start + n) % (MAX_SCOPES - 1)];
+			const char* existing = candidate->scope.load();
+			if (existing == NULL && candidate->scope.compare_exchange_strong(existing, scope)) existing = scope;
+			if (existing == scope) {
+				counter = candidate;
+				break;
+			}
+		}
+	}
+	counter->allocations.fetch_add(1, memory_order_relaxed);
+	counter->bytes.fetch_add(bytes, memory_order_relaxed);
+}
+
+// GLOBAL ALLOCATION FUNCTIONS ////////////////////////////////////////////////
+
+#ifdef TRACK_ALLOCATIONS
+
+void* operator new(size_t size)
+{
+	AllocationTracker::RecordAllocation(size);
+	void* p = malloc(size == 0 ? 1 : size);
+	if (p == NULL) throw bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	AllocationTracker::RecordAllocation(size);
+	void* p = malloc(size == 0 ? 1 : size);
+	if (p == NULL) throw bad_alloc();
+	return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+	AllocationTracker::RecordAllocation(size);
+	return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+	AllocationTracker::RecordAllocation(size);
+	return malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+// Over-aligned types are allocated through their own overloads, in
+// compilers that support them. Their memory comes from the platform's
+// aligned allocator, so it must go back through the matching free.
+#ifdef __cpp_aligned_new
+
+static void* AlignedAllocate(size_t size, align_val_t alignment)
+{
+	AllocationTracker::RecordAllocation(size);
+	if (size == 0) size = 1;
+#ifdef _MSC_VER
+	return _aligned_malloc(size, (size_t)alignment);
+#else
+	void* p = NULL;
+	if (posix_memalign(&p, (size_t)alignment, size) != 0) return NULL;
+	return p;
+#endif
+}
+
+static void AlignedFree(void* p)
+{
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+void* operator new(size_t size, align_val_t alignment)
+{
+	void* p = AlignedAllocate(size, alignment);
+	if (p == NULL) throw bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size, align_val_t alignment)
+{
+	void* p = AlignedAllocate(size, alignment);
+	if (p == NULL) throw bad_alloc();
+	return p;
+}
+
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept
+{
+	return AlignedAllocate(size, alignment);
+}
+
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept
+{
+	return AlignedAllocate(size, alignment);
+}
+
+void operator delete(void* p, align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { AlignedFree(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { AlignedFree(p); }
+
+#endif
+
+#endif
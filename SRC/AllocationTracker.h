@@ -0,0 +1,100 @@
+#ifndef __ALLOCATIONTRACKER_H__
+#define __ALLOCATIONTRACKER_H__
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+typedef unsigned int uint;
+
+// Heap allocations made inside one scope during a frame
+struct AllocationCount
+{
+	const char* scope;
+	uint allocations;
+	size_t bytes;
+};
+
+// Heap allocations made during one frame, in total and by scope
+struct AllocationFrame
+{
+	uint allocations;
+	size_t bytes;
+	std::vector<AllocationCount> scopes;
+};
+
+// Counts heap allocations per frame and attributes them to the innermost
+// PROFILE_SCOPE on the allocating thread. Allocations are only seen when
+// the program is built with TRACK_ALLOCATIONS defined, which replaces the
+// global operator new; otherwise the tracker records nothing.
+class AllocationTracker
+{
+public:
+	// Maximum number of distinct scopes counted; further scopes are
+	// counted as unscoped
+	static const uint MAX_SCOPES = 128;
+
+	inline static AllocationTracker& GetInstance(void)
+	{
+		static AllocationTracker mInstance;
+		return mInstance;
+	}
+
+	static bool IsAvailable(void);
+	inline static bool IsEnabled(void) { return mEnabled.load(std::memory_order_relaxed); }
+	void SetEnabled(bool enabled);
+
+	/** Called by operator new for every allocation. */
+	inline static void RecordAllocation(size_t bytes)
+	{
+		if (IsEnabled()) GetInstance().Record(bytes);
+	}
+
+	static const char* SetScope(const char* name);
+
+	void NewFrame(void);
+	const AllocationFrame& GetLastFrame(void) const { return mLastFrame; }
+
+private:
+	AllocationTracker(void);
+	~AllocationTracker(void) {}
+
+	void Record(size_t bytes);
+
+	// Counters for one scope. Entries are claimed by storing the scope name
+	// and are never released, so lookups and updates need no lock.
+	struct ScopeCounter
+	{
+		std::atomic<const char*> scope;
+		std::atomic<uint> allocations;
+		std::atomic<size_t> bytes;
+	};
+
+	ScopeCounter mCounters[MAX_SCOPES];
+	AllocationFrame mLastFrame;
+
+	// Checked by operator new on every thread. Nothing else is published
+	// through the flag, so relaxed loads are enough.
+	static std::atomic<bool> mEnabled;
+};
+
+// Attributes allocations on the calling thread to the named scope until
+// it goes out of scope. Opened by every PROFILE_SCOPE.
+class AllocationScope
+{
+public:
+	AllocationScope(const char* name)
+		: mActive(AllocationTracker::IsEnabled())
+	{
+		if (mActive) mPrevious = AllocationTracker::SetScope(name);
+	}
+	~AllocationScope()
+	{
+		if (mActive) AllocationTracker::SetScope(mPrevious);
+	}
+private:
+	bool mActive;
+	const char* mPrevious;
+};
+
+#endif
@@ -4,9 +4,11 @@
 #include "Image.h"
 #include "Texture.h"
 #include "Animation.h"
+#include "Profiler.h"
 
 Animation* AnimationManager::CreateAnimationFromFile(const string& name, const uint width, const uint height, const uint frame_width, const uint frame_height, const string& filename)
 {
+	PROFILE_SCOPE("AnimationManager::CreateAnimationFromFile");
 	Image* image = ImageManager::GetInstance().CreateImageFromFile(name, width, height, filename);
 	return CreateAnimationFromImage(name, frame_width, frame_height, image);
 }
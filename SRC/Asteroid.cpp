@@ -3,22 +3,42 @@
 #include "Asteroid.h"
 #include "BoundingShape.h"
 
-Asteroid::Asteroid(void) : GameObject("Asteroid")
+Asteroid::Asteroid(void) : GameObject("Asteroid"), mSize(MAX_SIZE)
 {
 	mAngle = rand() % 360;
 	mRotation = 0; // rand() % 90;
 	mPosition.x = rand() / 2;
 	mPosition.y = rand() / 2;
 	mPosition.z = 0.0;
-	mVelocity.x = 10.0 * cos(DEG2RAD*mAngle);
-	mVelocity.y = 10.0 * sin(DEG2RAD*mAngle);
-	mVelocity.z = 0.0;
+	mVelocity = GetHeading() * 10;
+	SetAnalyticMotion(true);
+}
+
+/** Construct an asteroid at the given position heading in the given direction. */
+Asteroid::Asteroid(GLVector3f p, GLfloat h)
+	: GameObject("Asteroid", p, GLVector3f(0, 0, 0), GLVector3f(0, 0, 0), h, 0),
+	  mSize(MAX_SIZE)
+{
+	mVelocity = GetHeading() * 10;
+	SetAnalyticMotion(true);
 }
 
 Asteroid::~Asteroid(void)
 {
 }
 
+/** Set an asteroid moving from the given position, heading in the given
+	direction at the given speed. Asteroids taken from a pool are set up
+	with this before they are added to a world, and may be given their
+	heading beforehand with SetHeading. */
+void Asteroid::Launch(GLVector3f p, GLfloat h, float speed, uint size)
+{
+	SetPosition(p);
+	SetAngle(h);
+	SetVelocity(GetHeading() * speed);
+	SetSize(size);
+}
+
 bool Asteroid::CollisionTest(shared_ptr<GameObject> o)
 {
 	if (GetType() == o->GetType()) return false;
@@ -27,7 +47,7 @@ bool Asteroid::CollisionTest(shared_ptr<GameObject> o)
 	return mBoundingShape->CollisionTest(o->GetBoundingShape());
 }
 
-void Asteroid::OnCollision(const GameObjectList& objects)
+void Asteroid::OnCollision(const ContactSpan& contacts)
 {
 	mWorld->FlagForRemoval(GetThisPtr());
 }
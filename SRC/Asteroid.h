@@ -7,10 +7,27 @@ class Asteroid : public GameObject
 {
 public:
 	Asteroid(void);
+	Asteroid(GLVector3f p, GLfloat h);
 	~Asteroid(void);
 
+	// Size of the asteroids a level starts with. Asteroids larger than one
+	// break into smaller ones when destroyed.
+	static const uint MAX_SIZE = 3;
+
+	// Collision radius and sprite scale of an asteroid of the given size
+	static constexpr float GetRadiusForSize(uint size) { return 10.0f * ((float)size / MAX_SIZE); }
+	static constexpr float GetScaleForSize(uint size) { return 0.2f * ((float)size / MAX_SIZE); }
+
+	void Launch(GLVector3f p, GLfloat h, float speed, uint size);
+
+	void SetSize(uint size) { mSize = size; }
+	uint GetSize() const { return mSize; }
+
 	bool CollisionTest(shared_ptr<GameObject> o);
-	void OnCollision(const GameObjectList& objects);
+	void OnCollision(const ContactSpan& contacts);
+
+private:
+	uint mSize;
 };
 
 #endif
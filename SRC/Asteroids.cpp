@@ -11,14 +11,26 @@
 #include "BoundingSphere.h"
 #include "GUILabel.h"
 #include "Explosion.h"
+#include "ParticleEffects.h"
+#include "FastTrig.h"
 
+// Number of smaller asteroids an asteroid breaks into
+static const uint NUM_FRAGMENTS = 2;
 
 // PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
 
 /** Constructor. Takes arguments from command line, just in case. */
 // modified constructor to set defualt value for mNextLifeScoreThreshold and setting difficulty normal by default
 Asteroids::Asteroids(int argc, char* argv[])
-	: GameSession(argc, argv) , mCurrentDifficulty(NORMAL)
+	: GameSession(argc, argv) , mCurrentDifficulty(NORMAL),
+	  mAsteroidPool([this] {
+		// Pooled asteroids are made with their bounding sphere and sprite,
+		// which they keep each time they are taken from the pool
+		Asteroid* asteroid = new Asteroid();
+		asteroid->SetBoundingShape(make_shared<BoundingSphere>());
+		SetAsteroidSprite(asteroid);
+		return asteroid;
+	  })
 {
 	mLevel = 0;
 	mAsteroidCount = 0;
@@ -41,8 +53,10 @@ void Asteroids::Start()
 	// Create a shared pointer for the Asteroids game object
 	shared_ptr<Asteroids> thisPtr = shared_ptr<Asteroids>(this);
 
-	// Add this class as a listener of the game world
+	// Add this class as a listener of the game world, and of the contacts
+	// asteroids receive
 	mGameWorld->AddListener(thisPtr.get());
+	mGameWorld->AddContactListener(GameObjectType("Asteroid"), thisPtr.get());
 
 	// Add this as a listener to the world and the keyboard
 	mGameWindow->AddKeyboardListener(thisPtr);
@@ -57,6 +71,13 @@ void Asteroids::Start()
 	Animation* explosion_anim = AnimationManager::GetInstance().CreateAnimationFromFile("explosion", 64, 1024, 64, 64, "explosion_fs.png");
 	Animation* asteroid1_anim = AnimationManager::GetInstance().CreateAnimationFromFile("asteroid1", 128, 8192, 128, 128, "asteroid1_fs.png");
 	Animation* spaceship_anim = AnimationManager::GetInstance().CreateAnimationFromFile("spaceship", 128, 128, 128, 128, "spaceship_fs.png");
+	mExplosionEmitter = CreateExplosionEmitter();
+	mDebrisEmitter = CreateDebrisEmitter();
+	// Every asteroid plays the same looping animation, so they all
+	// share one sprite
+	mAsteroidSprite = make_shared<Sprite>(asteroid1_anim->GetWidth(), asteroid1_anim->GetHeight(), asteroid1_anim);
+	mAsteroidSprite->SetLoopAnimation(true);
+	mAsteroidSprite->SetClocked(true);
 
 
 	mGameState = MENU;
@@ -222,14 +243,20 @@ void Asteroids::OnSpecialKeyReleased(int key, int x, int y)
 
 // PUBLIC INSTANCE METHODS IMPLEMENTING IGameWorldListener ////////////////////
 
+/** Add the pieces of the asteroids destroyed during the update to the
+	world, all at once. */
+void Asteroids::OnWorldUpdated(GameWorld* world)
+{
+	if (mFragments.empty()) return;
+	world->AddObjects(&mFragments[0], (uint)mFragments.size());
+	mFragments.clear();
+}
+
 void Asteroids::OnObjectRemoved(GameWorld* world, shared_ptr<GameObject> object)
 {
-	if (object->GetType() == GameObjectType("Asteroid"))
+	// Asteroids without a bounding shape are only scenery on the menu
+	if (object->GetType() == GameObjectType("Asteroid") && object->GetBoundingShape().get() != NULL)
 	{
-		shared_ptr<GameObject> explosion = CreateExplosion();
-		explosion->SetPosition(object->GetPosition());
-		explosion->SetRotation(object->GetRotation());
-		mGameWorld->AddObject(explosion);
 		mAsteroidCount--;
 		if (mAsteroidCount <= 0)
 		{
@@ -238,6 +265,25 @@ void Asteroids::OnObjectRemoved(GameWorld* world, shared_ptr<GameObject> object)
 	}
 }
 
+// PUBLIC INSTANCE METHODS IMPLEMENTING IContactListener //////////////////////
+
+/** Break every asteroid that was hit into smaller ones, in a burst of
+	particles rather than an explosion object each. Asteroids are destroyed
+	by whatever they hit, so they only break up here, not when removed from
+	the world for other reasons. The contacts for each asteroid are next to
+	each other, so each asteroid breaks once however many things hit it. */
+void Asteroids::OnContacts(GameWorld* world, const ContactSpan& contacts)
+{
+	GameObject* last = NULL;
+	for (const Contact& contact : contacts) {
+		if (contact.object == last) continue;
+		last = contact.object;
+		world->EmitParticles(mExplosionEmitter, last->GetPosition(), GLVector3f(0, 0, 0), 0);
+		world->EmitParticles(mDebrisEmitter, last->GetPosition(), last->GetVelocity(), 0);
+		BreakAsteroid(static_cast<Asteroid*>(last));
+	}
+}
+
 // PUBLIC INSTANCE METHODS IMPLEMENTING ITimerListener ////////////////////////
 
 // updated method to activate invulnerability after respawning 
@@ -275,9 +321,11 @@ shared_ptr<GameObject> Asteroids::CreateSpaceship()
 	mSpaceship->SetBoundingShape(make_shared<BoundingSphere>(mSpaceship->GetThisPtr(), 4.0f));
 	shared_ptr<Shape> bullet_shape = make_shared<Shape>("bullet.shape");
 	mSpaceship->SetBulletShape(bullet_shape);
+	mSpaceship->SetThrusterEmitter(CreateThrusterEmitter());
 	Animation* anim_ptr = AnimationManager::GetInstance().GetAnimationByName("spaceship");
 	shared_ptr<Sprite> spaceship_sprite =
 		make_shared<Sprite>(anim_ptr->GetWidth(), anim_ptr->GetHeight(), anim_ptr);
+	spaceship_sprite->SetClocked(true);
 	mSpaceship->SetSprite(spaceship_sprite);
 	mSpaceship->SetScale(0.1f);
 	// Reset spaceship back to centre of the world
@@ -287,21 +335,80 @@ shared_ptr<GameObject> Asteroids::CreateSpaceship()
 
 }
 
+/** Add a level's asteroids to the world. The pool is filled with enough
+	asteroids for every piece they can break into, so breaking them up
+	never has to make more. */
 void Asteroids::CreateAsteroids(const uint num_asteroids)
 {
+	uint pieces = 0;
+	for (uint size = 1, count = 1; size <= Asteroid::MAX_SIZE; size++, count *= NUM_FRAGMENTS) pieces += count;
+	mAsteroidPool.Reserve(num_asteroids * pieces);
+
 	mAsteroidCount = num_asteroids;
+	vector<shared_ptr<GameObject>> asteroids;
+	mAsteroidPool.Acquire(num_asteroids, asteroids);
+
+	// Pick every asteroid's position and direction first, so their headings
+	// can be worked out together
+	vector<GLVector3f> positions(num_asteroids);
+	vector<float> angles(num_asteroids), sines(num_asteroids), cosines(num_asteroids);
 	for (uint i = 0; i < num_asteroids; i++)
 	{
-		Animation* anim_ptr = AnimationManager::GetInstance().GetAnimationByName("asteroid1");
-		shared_ptr<Sprite> asteroid_sprite
-			= make_shared<Sprite>(anim_ptr->GetWidth(), anim_ptr->GetHeight(), anim_ptr);
-		asteroid_sprite->SetLoopAnimation(true);
-		shared_ptr<GameObject> asteroid = make_shared<Asteroid>();
-		asteroid->SetBoundingShape(make_shared<BoundingSphere>(asteroid->GetThisPtr(), 10.0f));
-		asteroid->SetSprite(asteroid_sprite);
-		asteroid->SetScale(0.2f);
-		mGameWorld->AddObject(asteroid);
+		positions[i].x = rand() / 2;
+		positions[i].y = rand() / 2;
+		positions[i].z = 0;
+		angles[i] = rand() % 360;
 	}
+	SinCosDegrees(&angles[0], &sines[0], &cosines[0], num_asteroids);
+
+	for (uint i = 0; i < num_asteroids; i++)
+	{
+		Asteroid* asteroid = static_cast<Asteroid*>(asteroids[i].get());
+		asteroid->SetHeading(angles[i], GLVector3f(cosines[i], sines[i], 0));
+		asteroid->Launch(positions[i], angles[i], 10, Asteroid::MAX_SIZE);
+		SetAsteroidSize(asteroid, Asteroid::MAX_SIZE);
+	}
+	mGameWorld->AddObjects(&asteroids[0], num_asteroids);
+}
+
+/** Give an asteroid the sprite every asteroid shares, at a random phase
+	so they don't all turn in step, drawn in a batch with the others. */
+void Asteroids::SetAsteroidSprite(GameObject* asteroid)
+{
+	asteroid->SetSprite(mAsteroidSprite);
+	asteroid->SetSpritePhase(mAsteroidSprite->GetDuration() * (rand() % 1000) / 1000.0);
+	asteroid->SetBatchedSprite(true);
+}
+
+/** Scale an asteroid and its bounding sphere to its size. */
+void Asteroids::SetAsteroidSize(Asteroid* asteroid, uint size)
+{
+	asteroid->SetSize(size);
+	asteroid->SetScale(Asteroid::GetScaleForSize(size));
+	static_cast<BoundingSphere*>(asteroid->GetBoundingShape().get())->SetRadius(Asteroid::GetRadiusForSize(size));
+}
+
+/** Break a destroyed asteroid into smaller ones, flying apart either side
+	of its heading, faster the smaller they are. The pieces are added to
+	the world once it has finished updating. */
+void Asteroids::BreakAsteroid(Asteroid* asteroid)
+{
+	if (asteroid->GetSize() <= 1) return;
+	uint size = asteroid->GetSize() - 1;
+	float speed = asteroid->GetVelocity().length() + 5;
+	GLVector3f position = asteroid->GetPosition();
+	GLfloat heading = asteroid->GetAngle();
+
+	uint first = (uint)mFragments.size();
+	mAsteroidPool.Acquire(NUM_FRAGMENTS, mFragments);
+	for (uint i = 0; i < NUM_FRAGMENTS; i++)
+	{
+		Asteroid* fragment = static_cast<Asteroid*>(mFragments[first + i].get());
+		GLfloat h = heading + 360.0f * (i + 0.5f) / NUM_FRAGMENTS + (rand() % 60 - 30);
+		fragment->Launch(position, h, speed, size);
+		SetAsteroidSize(fragment, size);
+	}
+	mAsteroidCount += NUM_FRAGMENTS;
 }
 
 void Asteroids::CreateGUI()
@@ -382,14 +489,11 @@ void Asteroids::OnPlayerKilled(int lives_left)
 // New function to create main menu at the start 
 void Asteroids::CreateMenu()
 {
-	// Creating menu asteroids background 
+	// Creating menu asteroids background. They are only scenery, so they
+	// have no bounding shape and never take part in collisions
 	for (int i = 0; i < 15; i++) {
-		Animation* anim_ptr = AnimationManager::GetInstance().GetAnimationByName("asteroid1");
-		shared_ptr<Sprite> asteroid_sprite = make_shared<Sprite>(anim_ptr->GetWidth(), anim_ptr->GetHeight(), anim_ptr);
-		asteroid_sprite->SetLoopAnimation(true);
 		shared_ptr<GameObject> asteroid = make_shared<Asteroid>();
-		asteroid->SetBoundingShape(make_shared<BoundingSphere>(asteroid->GetThisPtr(), 10.0f));
-		asteroid->SetSprite(asteroid_sprite);
+		SetAsteroidSprite(asteroid.get());
 		asteroid->SetScale(0.15f);
 		mMenuAsteroids.push_back(asteroid);
 		mGameWorld->AddObject(asteroid);
@@ -476,6 +580,10 @@ void Asteroids::StartGame() {
 	mLivesLabel->SetVisible(true);
 
 	mGameWorld->AddObject(CreateSpaceship());
+	// Follow the spaceship around worlds larger than the view
+	if (mGameWorld->GetWorldWidth() > mGameWorld->GetViewWidth() || mGameWorld->GetWorldHeight() > mGameWorld->GetViewHeight()) {
+		mGameWorld->SetCameraTarget(mSpaceship);
+	}
 	CreateAsteroids(10);
 
 	mGameWorld->AddListener(&mScoreKeeper);
@@ -522,6 +630,11 @@ void Asteroids::ReturnToMenu() {
 
 	ClearDifficultyMenu();
 
+	// Stop following the last game's spaceship and look at the middle of
+	// the world again
+	mGameWorld->SetCameraTarget(weak_ptr<GameObject>());
+	mGameWorld->SetView(GLVector3f(0, 0, 0), mGameWorld->GetViewWidth(), mGameWorld->GetViewHeight());
+
 
 	for (auto label : mHighScoreLabels) {
 		mGameDisplay->GetContainer()->RemoveComponent(
@@ -545,12 +658,8 @@ void Asteroids::ReturnToMenu() {
 
 	if (mMenuAsteroids.empty()) {
 		for (int i = 0; i < 15; i++) {
-			Animation* anim_ptr = AnimationManager::GetInstance().GetAnimationByName("asteroid1");
-			shared_ptr<Sprite> asteroid_sprite = make_shared<Sprite>(anim_ptr->GetWidth(), anim_ptr->GetHeight(), anim_ptr);
-			asteroid_sprite->SetLoopAnimation(true);
 			shared_ptr<GameObject> asteroid = make_shared<Asteroid>();
-			asteroid->SetBoundingShape(make_shared<BoundingSphere>(asteroid->GetThisPtr(), 10.0f));
-			asteroid->SetSprite(asteroid_sprite);
+			SetAsteroidSprite(asteroid.get());
 			asteroid->SetScale(0.15f);
 			mMenuAsteroids.push_back(asteroid);
 			mGameWorld->AddObject(asteroid);
@@ -801,6 +910,7 @@ shared_ptr<GameObject> Asteroids::CreateExplosion()
 	shared_ptr<Sprite> explosion_sprite =
 		make_shared<Sprite>(anim_ptr->GetWidth(), anim_ptr->GetHeight(), anim_ptr);
 	explosion_sprite->SetLoopAnimation(false);
+	explosion_sprite->SetClocked(true);
 	shared_ptr<GameObject> explosion = make_shared<Explosion>();
 	explosion->SetSprite(explosion_sprite);
 	explosion->Reset();
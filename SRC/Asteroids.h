@@ -5,10 +5,12 @@
 #include "GameSession.h"
 #include "IKeyboardListener.h"
 #include "IGameWorldListener.h"
+#include "IContactListener.h"
 #include "IScoreListener.h" 
 #include "ScoreKeeper.h"
 #include "Player.h"
 #include "IPlayerListener.h"
+#include "GameObjectPool.h"
 
 //New header includes
 #include "vector"
@@ -20,8 +22,10 @@
 
 
 class GameObject;
+class Asteroid;
 class Spaceship;
 class GUILabel;
+struct ParticleEmitter;
 
 //  this enum is to keep track of different game states 
 enum GameState {
@@ -44,7 +48,7 @@ enum Difficulty {
 
 
 
-class Asteroids : public GameSession, public IKeyboardListener, public IGameWorldListener, public IScoreListener, public IPlayerListener
+class Asteroids : public GameSession, public IKeyboardListener, public IGameWorldListener, public IContactListener, public IScoreListener, public IPlayerListener
 {
 public:
 	Asteroids(int argc, char* argv[]);
@@ -70,10 +74,14 @@ public:
 
 	// Declaration of IGameWorldListener interface //////////////////////////////
 
-	void OnWorldUpdated(GameWorld* world) {}
+	void OnWorldUpdated(GameWorld* world);
 	void OnObjectAdded(GameWorld* world, shared_ptr<GameObject> object) {}
 	void OnObjectRemoved(GameWorld* world, shared_ptr<GameObject> object);
 
+	// Declaration of IContactListener interface ////////////////////////////////
+
+	void OnContacts(GameWorld* world, const ContactSpan& contacts);
+
 	// Override the default implementation of ITimerListener ////////////////////
 	void OnTimer(int value);
 
@@ -101,10 +109,23 @@ private:
 	uint mLevel;
 	uint mAsteroidCount;
 
+	shared_ptr<ParticleEmitter> mExplosionEmitter;
+	shared_ptr<ParticleEmitter> mDebrisEmitter;
+
+	// Asteroids come and go in large numbers as they break up, so they are
+	// taken from a pool, sharing one sprite, and the pieces of those
+	// destroyed in an update are added to the world together after it
+	GameObjectPool<Asteroid> mAsteroidPool;
+	shared_ptr<Sprite> mAsteroidSprite;
+	vector<shared_ptr<GameObject>> mFragments;
+
 	void ResetSpaceship();
 	shared_ptr<GameObject> CreateSpaceship();
 	void CreateGUI();
 	void CreateAsteroids(const uint num_asteroids);
+	void SetAsteroidSprite(GameObject* asteroid);
+	void SetAsteroidSize(Asteroid* asteroid, uint size);
+	void BreakAsteroid(Asteroid* asteroid);
 	shared_ptr<GameObject> CreateExplosion();
 
 	const static uint SHOW_GAME_OVER = 0;
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <random>
+#include "GameUtil.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "Asteroid.h"
+#include "Spaceship.h"
+#include "BoundingSphere.h"
+#include "ScoreKeeper.h"
+#include "JobScheduler.h"
+#include "BatchEnvironment.h"
+
+static const GameObjectType ASTEROID_TYPE("Asteroid");
+static const GameObjectType SPACESHIP_TYPE("Spaceship");
+
+/** A single headless game of asteroids: a world, a spaceship and a score. */
+class BatchEnvironmentSlot : public IGameWorldListener
+{
+public:
+	BatchEnvironmentSlot() : mWorld(NULL), mLevel(0), mAsteroidCount(0), mLastScore(0), mDone(false) {}
+	virtual ~BatchEnvironmentSlot() { delete mWorld; }
+
+	void Reset(uint seed, int w, int h);
+	void Restart(int w, int h) { Reset(mRandom(), w, h); }
+	void Step(const BatchAction& action, int t, float& reward, uchar& done);
+	void Observe(float* obs);
+
+	// Declaration of IGameWorldListener interface //////////////////////////////
+
+	void OnWorldUpdated(GameWorld* world) {}
+	void OnObjectAdded(GameWorld* world, shared_ptr<GameObject> object) {}
+	void OnObjectRemoved(GameWorld* world, shared_ptr<GameObject> object)
+	{
+		if (object->GetType() == SPACESHIP_TYPE) mDone = true;
+		if (object->GetType() == ASTEROID_TYPE) mAsteroidCount--;
+	}
+
+private:
+	void CreateAsteroids(uint num_asteroids);
+
+	GameWorld* mWorld;
+	ScoreKeeper mScoreKeeper;
+	shared_ptr<Spaceship> mSpaceship;
+	mt19937 mRandom;
+
+	uint mLevel;
+	uint mAsteroidCount;
+	int mLastScore;
+	bool mDone;
+
+	// Reused between steps to find the nearest asteroids
+	vector< pair<float, GameObject*> > mNearest;
+};
+
+/** Start a new episode with a fresh world. */
+void BatchEnvironmentSlot::Reset(uint seed, int w, int h)
+{
+	delete mWorld;
+	mWorld = new GameWorld();
+	mWorld->SetWidth(w);
+	mWorld->SetHeight(h);
+	mWorld->AddListener(this);
+	mScoreKeeper = ScoreKeeper();
+	mWorld->AddListener(&mScoreKeeper);
+	mRandom.seed(seed);
+
+	mSpaceship = make_shared<Spaceship>();
+	mSpaceship->SetBoundingShape(make_shared<BoundingSphere>(mSpaceship->GetThisPtr(), 4.0f));
+	mSpaceship->Reset();
+	mSpaceship->Thrust(0);
+	mWorld->AddObject(mSpaceship);
+
+	mLevel = 0;
+	mAsteroidCount = 0;
+	mLastScore = 0;
+	mDone = false;
+	CreateAsteroids(10);
+}
+
+/** Apply an action and advance the world by t milliseconds. */
+void BatchEnvironmentSlot::Step(const BatchAction& action, int t, float& reward, uchar& done)
+{
+	mSpaceship->Thrust(action.thrust);
+	mSpaceship->Rotate(action.rotate);
+	if (action.shoot) mSpaceship->Shoot();
+
+	mWorld->Update(t);
+
+	// Start the next level as soon as the current one is cleared
+	if (mAsteroidCount == 0 && !mDone) {
+		mLevel++;
+		CreateAsteroids(10 + 2 * mLevel);
+	}
+
+	reward = (float)(mScoreKeeper.GetScore() - mLastScore);
+	mLastScore = mScoreKeeper.GetScore();
+	done = mDone ? 1 : 0;
+}
+
+/** Write the current observation for this environment. */
+void BatchEnvironmentSlot::Observe(float* obs)
+{
+	GLVector3f ship_position = mSpaceship->GetPosition();
+	GLVector3f ship_velocity = mSpaceship->GetVelocity();
+	const GLVector3f& ship_heading = mSpaceship->GetHeading();
+	*obs++ = ship_position.x;
+	*obs++ = ship_position.y;
+	*obs++ = ship_velocity.x;
+	*obs++ = ship_velocity.y;
+	*obs++ = ship_heading.x;
+	*obs++ = ship_heading.y;
+
+	// Collect every asteroid with its squared distance, measured the short
+	// way around the world's edges
+	mNearest.clear();
+	float w = mWorld->GetWorldWidth();
+	float h = mWorld->GetWorldHeight();
+	const GameObjectList& objects = mWorld->GetGameObjects();
+	for (GameObjectList::const_iterator it = objects.begin(); it != objects.end(); ++it) {
+		if ((*it)->GetType() != ASTEROID_TYPE) continue;
+		GLVector3f d = (*it)->GetPosition() - ship_position;
+		if (d.x > w/2) d.x -= w; else if (d.x < -w/2) d.x += w;
+		if (d.y > h/2) d.y -= h; else if (d.y < -h/2) d.y += h;
+		mNearest.push_back(make_pair(d.x * d.x + d.y * d.y, it->get()));
+	}
+
+	uint n = min((uint)mNearest.size(), BatchEnvironment::NEAREST_ASTEROIDS);
+	partial_sort(mNearest.begin(), mNearest.begin() + n, mNearest.end());
+	for (uint i = 0; i < BatchEnvironment::NEAREST_ASTEROIDS; i++) {
+		if (i < n) {
+			GameObject* asteroid = mNearest[i].second;
+			GLVector3f d = asteroid->GetPosition() - ship_position;
+			if (d.x > w/2) d.x -= w; else if (d.x < -w/2) d.x += w;
+			if (d.y > h/2) d.y -= h; else if (d.y < -h/2) d.y += h;
+			GLVector3f v = asteroid->GetVelocity() - ship_velocity;
+			*obs++ = d.x;
+			*obs++ = d.y;
+			*obs++ = v.x;
+			*obs++ = v.y;
+		} else {
+			*obs++ = 0; *obs++ = 0; *obs++ = 0; *obs++ = 0;
+		}
+	}
+}
+
+/** Add asteroids at random positions away from the spaceship. */
+void BatchEnvironmentSlot::CreateAsteroids(uint num_asteroids)
+{
+	uniform_real_distribution<float> x_dist(-mWorld->GetWorldWidth()/2, mWorld->GetWorldWidth()/2);
+	uniform_real_distribution<float> y_dist(-mWorld->GetWorldHeight()/2, mWorld->GetWorldHeight()/2);
+	uniform_real_distribution<float> angle_dist(0, 360);
+	mAsteroidCount += num_asteroids;
+	for (uint i = 0; i < num_asteroids; i++) {
+		GLVector3f p;
+		do {
+			p = GLVector3f(x_dist(mRandom), y_dist(mRandom), 0);
+		} while ((p - mSpaceship->GetPosition()).lengthSqr() < 30 * 30);
+		shared_ptr<GameObject> asteroid = make_shared<Asteroid>(p, angle_dist(mRandom));
+		asteroid->SetBoundingShape(make_shared<BoundingSphere>(asteroid->GetThisPtr(), 10.0f));
+		mWorld->AddObject(asteroid);
+	}
+}
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Construct a batch of independent environments stepped across the given
+	number of threads (zero uses one per core). Call Reset() before stepping. */
+BatchEnvironment::BatchEnvironment(uint num_environments, uint num_threads)
+	: mJobScheduler(new JobScheduler(num_threads)),
+	  mObservations(num_environments * OBSERVATION_SIZE, 0.0f),
+	  mRewards(num_environments, 0.0f),
+	  mDones(num_environments, 0),
+	  mWorldWidth(200),
+	  mWorldHeight(200),
+	  mStepMillis(20)
+{
+	for (uint i = 0; i < num_environments; i++) {
+		mSlots.push_back(new BatchEnvironmentSlot());
+	}
+}
+
+/** Destructor. */
+BatchEnvironment::~BatchEnvironment(void)
+{
+	for (uint i = 0; i < mSlots.size(); i++) delete mSlots[i];
+	delete mJobScheduler;
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Reset every environment. Environment i is seeded with seed + i so runs
+	are reproducible regardless of the number of threads. */
+void BatchEnvironment::Reset(uint seed)
+{
+	mJobScheduler->ParallelFor(GetNumEnvironments(), [&](uint i) {
+		mSlots[i]->Reset(seed + i, mWorldWidth, mWorldHeight);
+		mSlots[i]->Observe(&mObservations[i * OBSERVATION_SIZE]);
+		mRewards[i] = 0;
+		mDones[i] = 0;
+	});
+}
+
+/** Step every environment with its action. Environments that finish are
+	reset straight away, so the observation returned for a done environment
+	is the first of its next episode. */
+void BatchEnvironment::Step(const BatchAction* actions)
+{
+	mJobScheduler->ParallelFor(GetNumEnvironments(), [&](uint i) {
+		mSlots[i]->Step(actions[i], mStepMillis, mRewards[i], mDones[i]);
+		if (mDones[i]) {
+			mSlots[i]->Restart(mWorldWidth, mWorldHeight);
+		}
+		mSlots[i]->Observe(&mObservations[i * OBSERVATION_SIZE]);
+	});
+}
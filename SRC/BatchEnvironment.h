@@ -0,0 +1,67 @@
+#ifndef __BATCHENVIRONMENT_H__
+#define __BATCHENVIRONMENT_H__
+
+#include "GameUtil.h"
+#include <vector>
+
+class JobScheduler;
+class BatchEnvironmentSlot;
+
+// One set of controls for a single environment, applied for a single step
+struct BatchAction
+{
+	// Thrust applied to the spaceship, 0 to stop thrusting
+	float thrust;
+	// Rotation rate in degrees per second, 0 to stop rotating
+	float rotate;
+	// Fire a bullet this step if non-zero
+	int shoot;
+};
+
+// Runs many games of asteroids side by side for training bots, stepping
+// each game's world directly with no window or display. Nothing it does
+// calls GLUT or draws. It is built on the engine, though, whose headers
+// include GL/glut.h through GameUtil.h, so GLUT is still needed to build
+// and link it.
+class BatchEnvironment
+{
+public:
+	// Number of nearest asteroids included in each observation
+	static const uint NEAREST_ASTEROIDS = 8;
+	// Floats per observation: spaceship position, velocity and heading,
+	// then relative position and velocity of each nearest asteroid
+	static const uint OBSERVATION_SIZE = 6 + 4 * NEAREST_ASTEROIDS;
+
+	BatchEnvironment(uint num_environments, uint num_threads = 0);
+	~BatchEnvironment(void);
+
+	void Reset(uint seed);
+	void Step(const BatchAction* actions);
+
+	uint GetNumEnvironments() const { return (uint)mSlots.size(); }
+
+	void SetWorldSize(int w, int h) { mWorldWidth = w; mWorldHeight = h; }
+	void SetStepMillis(int t) { mStepMillis = t; }
+	int GetStepMillis() const { return mStepMillis; }
+
+	const float* GetObservations() const { return &mObservations[0]; }
+	const float* GetRewards() const { return &mRewards[0]; }
+	const uchar* GetDones() const { return &mDones[0]; }
+
+private:
+	BatchEnvironment(const BatchEnvironment&);
+	BatchEnvironment& operator= (const BatchEnvironment&);
+
+	JobScheduler* mJobScheduler;
+	std::vector<BatchEnvironmentSlot*> mSlots;
+
+	std::vector<float> mObservations;
+	std::vector<float> mRewards;
+	std::vector<uchar> mDones;
+
+	int mWorldWidth;
+	int mWorldHeight;
+	int mStepMillis;
+};
+
+#endif
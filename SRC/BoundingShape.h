@@ -13,6 +13,10 @@ public:
 		: mType(type_name), mGameObject(o) {}
 
 	virtual bool CollisionTest(shared_ptr<BoundingShape> bshape) { return false; }
+	virtual bool GetContact(const shared_ptr<BoundingShape>& bshape, Contact& contact) { return false; }
+	/** Get the radius of a circle around the object's position that
+		contains the shape, used by the world's broad phase. */
+	virtual float GetBoundingRadius() { return 0; }
 	
 	const GameObjectType& GetType() const { return mType; }
 
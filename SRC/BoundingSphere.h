@@ -15,17 +15,96 @@ public:
 	bool CollisionTest(shared_ptr<BoundingShape> bs) {
 		if (GetType() == bs->GetType()) {
 			BoundingSphere* bsphere = (BoundingSphere*)bs.get();
-			GLVector3f pos1 = GetGameObject()->GetPosition();
-			GLVector3f pos2 = bsphere->GetGameObject()->GetPosition();
-			float distanceSqr = (pos2 - pos1).lengthSqr();
+			if (IsSwept(bsphere)) {
+				float time_of_impact;
+				GLVector3f offset;
+				return Sweep(bsphere, time_of_impact, offset);
+			}
+			float distanceSqr = GetOffset(bsphere).lengthSqr();
 			float collision_distance = GetRadius() + bsphere->GetRadius();
 			return (distanceSqr <= pow(collision_distance, 2));
 		}
 		return false;
 	}
 
+	/** Fill in the normal, depth and time of impact of the overlap with
+		another sphere. Swept contacts are measured at the time of impact. */
+	bool GetContact(const shared_ptr<BoundingShape>& bs, Contact& contact) {
+		if (GetType() != bs->GetType()) return false;
+		BoundingSphere* bsphere = (BoundingSphere*)bs.get();
+		GLVector3f offset;
+		contact.time_of_impact = 1;
+		if (!IsSwept(bsphere) || !Sweep(bsphere, contact.time_of_impact, offset)) {
+			offset = GetOffset(bsphere);
+		}
+		float distance = offset.length();
+		// Pick an arbitrary normal for concentric spheres
+		contact.normal = distance > 0 ? offset / distance : GLVector3f(1, 0, 0);
+		contact.depth = GetRadius() + bsphere->GetRadius() - distance;
+		return true;
+	}
+
+	/** Get the offset from this sphere to another, taken the short way
+		around the world's edges, so spheres overlapping across an edge are
+		found to touch. */
+	GLVector3f GetOffset(BoundingSphere* bsphere) {
+		shared_ptr<GameObject> object1 = GetGameObject();
+		shared_ptr<GameObject> object2 = bsphere->GetGameObject();
+		GameWorld* world = object1->GetWorld();
+		if (world) return world->GetWrappedOffset(object1->GetPosition(), object2->GetPosition());
+		return object2->GetPosition() - object1->GetPosition();
+	}
+
+	/** Returns true if tests against another sphere should be swept. */
+	bool IsSwept(BoundingSphere* bsphere) {
+		return GetGameObject()->IsFastMover() || bsphere->GetGameObject()->IsFastMover();
+	}
+
+	/** Sweep this sphere and another from their positions at the start of
+		the last update to their current positions. Returns true if they
+		touched during the update, giving the earliest time they touched as
+		a fraction of the update and the offset between them at that time.
+		Offsets and motion are taken the short way around the world's edges,
+		so objects that wrapped during the update are handled. */
+	bool Sweep(BoundingSphere* bsphere, float& time_of_impact, GLVector3f& offset) {
+		shared_ptr<GameObject> object1 = GetGameObject();
+		shared_ptr<GameObject> object2 = bsphere->GetGameObject();
+		GameWorld* world = object1->GetWorld();
+		GLVector3f start, motion;
+		if (world) {
+			start = world->GetWrappedOffset(object1->GetPreviousPosition(), object2->GetPreviousPosition());
+			motion = world->GetWrappedOffset(object2->GetPreviousPosition(), object2->GetPosition())
+				- world->GetWrappedOffset(object1->GetPreviousPosition(), object1->GetPosition());
+		} else {
+			start = object2->GetPreviousPosition() - object1->GetPreviousPosition();
+			motion = (object2->GetPosition() - object2->GetPreviousPosition())
+				- (object1->GetPosition() - object1->GetPreviousPosition());
+		}
+
+		// Solve |start + motion * t| = radius for the first t in [0, 1]
+		float radius = GetRadius() + bsphere->GetRadius();
+		float c = start.lengthSqr() - radius * radius;
+		if (c <= 0) {
+			// Already touching when the update started
+			time_of_impact = 0;
+			offset = start;
+			return true;
+		}
+		float a = motion.lengthSqr();
+		if (a <= 0) return false;
+		float b = 2 * start.dot(motion);
+		float discriminant = b * b - 4 * a * c;
+		if (discriminant < 0) return false;
+		float t = (-b - sqrt(discriminant)) / (2 * a);
+		if (t < 0 || t > 1) return false;
+		time_of_impact = t;
+		offset = start + motion * t;
+		return true;
+	}
+
 	void SetRadius(float r) { mRadius = r; }
 	float GetRadius() { return mRadius; }
+	float GetBoundingRadius() { return mRadius; }
 
 protected:
 	float mRadius;
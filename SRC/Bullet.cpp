@@ -4,16 +4,19 @@
 
 // PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
 
-/** Constructor. Bullets live for 2s by default. */
+/** Constructor. Bullets live for 2s by default. Bullets are fast movers,
+	so they can't pass through small objects on long frames. */
 Bullet::Bullet()
 	: GameObject("Bullet"), mTimeToLive(2000)
 {
+	mFastMover = true;
 }
 
 /** Construct a new bullet with given position, velocity, acceleration, angle, rotation and lifespan. */
 Bullet::Bullet(GLVector3f p, GLVector3f v, GLVector3f a, GLfloat h, GLfloat r, int ttl)
 	: GameObject("Bullet", p, v, a, h, r), mTimeToLive(ttl)
 {
+	mFastMover = true;
 }
 
 /** Copy constructor. */
@@ -54,7 +57,7 @@ bool Bullet::CollisionTest(shared_ptr<GameObject> o)
 	return mBoundingShape->CollisionTest(o->GetBoundingShape());
 }
 
-void Bullet::OnCollision(const GameObjectList& objects)
+void Bullet::OnCollision(const ContactSpan& contacts)
 {
 	mWorld->FlagForRemoval(GetThisPtr());
 }
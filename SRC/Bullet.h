@@ -18,7 +18,7 @@ public:
 	int GetTimeToLive(void) { return mTimeToLive; }
 
 	bool CollisionTest(shared_ptr<GameObject> o);
-	void OnCollision(const GameObjectList& objects);
+	void OnCollision(const ContactSpan& contacts);
 
 protected:
 	int mTimeToLive;
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include "GameUtil.h"
+#include "GameObject.h"
+#include "GameWorld.h"
+#include "BoundingShape.h"
+#include "CollisionGrid.h"
+
+// Most cells the grid may have for each cell its objects want, when they
+// are crowded into part of the world
+static const uint MAX_CELL_RATIO = 8;
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Default constructor. The grid is empty until it is first built. */
+CollisionGrid::CollisionGrid()
+	: mWidth(0),
+	  mHeight(0),
+	  mCellWidth(0),
+	  mCellHeight(0),
+	  mColumns(0),
+	  mRows(0),
+	  mRanges(NULL),
+	  mCellStart(NULL),
+	  mCellObjects(NULL)
+{
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Build the grid for the given objects, allocating from the given arena.
+	An object's bounds cover its bounding radius around both its position
+	at the start of the last update and its current position, so fast
+	movers are entered in every cell along their path. Cells are sized to
+	hold the largest object and to keep the number of cells at around
+	twice the number of objects over the area they are spread across,
+	which is the whole world unless an area is given. */
+void CollisionGrid::Build(FrameArena& arena, const shared_ptr<GameObject>* const* objects, uint num_objects, const GameWorld& world, float area)
+{
+	// Find the bounds of every object that takes part in collisions
+	Bounds* bounds = arena.Allocate<Bounds>(num_objects);
+	uint num_colliders = 0;
+	float max_size = 0;
+	for (uint i = 0; i < num_objects; i++) {
+		GameObject& object = **objects[i];
+		const shared_ptr<BoundingShape>& shape = object.GetBoundingShape();
+		bounds[i].valid = shape.get() != NULL;
+		if (!bounds[i].valid) continue;
+		float radius = shape->GetBoundingRadius();
+		GLVector3f position = object.GetPosition();
+		GLVector3f start = position - world.GetWrappedOffset(object.GetPreviousPosition(), position);
+		bounds[i].x0 = min(start.x, position.x) - radius;
+		bounds[i].y0 = min(start.y, position.y) - radius;
+		bounds[i].x1 = max(start.x, position.x) + radius;
+		bounds[i].y1 = max(start.y, position.y) + radius;
+		max_size = max(max_size, 2 * radius);
+		num_colliders++;
+	}
+
+	BuildFromBounds(arena, bounds, num_objects, num_colliders, max_size, area, world);
+}
+
+/** Returns true if the given cell is the first, in cell order, that the
+	objects at two indices share. Testing a pair only in the first cell
+	they share tests each pair exactly once, whichever cells are visited
+	and in whatever order. */
+bool CollisionGrid::IsFirstSharedCell(uint cell, uint i, uint j) const
+{
+	const CellRange& range = mRanges[i];
+	const CellRange& other = mRanges[j];
+	for (int y = range.y0; y <= range.y1; y++) {
+		int row = Wrap(y, mRows);
+		if ((uint)(row * mColumns) > cell) continue;
+		if (!InRange(row, other.y0, other.y1, mRows)) continue;
+		for (int x = range.x0; x <= range.x1; x++) {
+			uint shared = row * mColumns + Wrap(x, mColumns);
+			if (shared < cell && InRange(Wrap(x, mColumns), other.x0, other.x1, mColumns)) return false;
+		}
+	}
+	return true;
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Size the grid for the given bounds and enter each object in the cells
+	its bounds overlap. */
+void CollisionGrid::BuildFromBounds(FrameArena& arena, const Bounds* bounds, uint num_objects, uint num_valid, float max_size, float area, const GameWorld& world)
+{
+	mWidth = max(world.GetWorldWidth(), 1.0f);
+	mHeight = max(world.GetWorldHeight(), 1.0f);
+	if (area <= 0 || area > mWidth * mHeight) area = mWidth * mHeight;
+
+	// Choose the cell size. Cells divide the world exactly, so the grid
+	// wraps where the world does. Objects crowded into part of the world
+	// get smaller cells, but never so small that the empty cells elsewhere
+	// cost more to clear than the objects do to enter.
+	uint num_cells_wanted = 2 * max(num_valid, 1u);
+	float cell_size = max(max_size, (float)sqrt(area / num_cells_wanted));
+	cell_size = max(cell_size, (float)sqrt(mWidth * mHeight / (MAX_CELL_RATIO * num_cells_wanted)));
+	mColumns = max((int)(mWidth / cell_size), 1);
+	mRows = max((int)(mHeight / cell_size), 1);
+	mCellWidth = mWidth / mColumns;
+	mCellHeight = mHeight / mRows;
+
+	// Find the cells each object overlaps. Bounds that span the whole world
+	// cover every row or column once.
+	mRanges = arena.Allocate<CellRange>(num_objects);
+	for (uint i = 0; i < num_objects; i++) {
+		CellRange& range = mRanges[i];
+		if (!bounds[i].valid) {
+			range.x0 = range.y0 = 0;
+			range.x1 = range.y1 = -1;
+			continue;
+		}
+		range.x0 = GetColumn(bounds[i].x0);
+		range.y0 = GetRow(bounds[i].y0);
+		range.x1 = GetColumn(bounds[i].x1);
+		range.y1 = GetRow(bounds[i].y1);
+		if (range.x1 - range.x0 + 1 >= mColumns) { range.x0 = 0; range.x1 = mColumns - 1; }
+		if (range.y1 - range.y0 + 1 >= mRows) { range.y0 = 0; range.y1 = mRows - 1; }
+	}
+
+	// Count the objects in each cell, then fill the cells in object order
+	uint num_cells = GetNumCells();
+	mCellStart = arena.Allocate<uint>(num_cells + 1);
+	for (uint cell = 0; cell <= num_cells; cell++) mCellStart[cell] = 0;
+	for (uint i = 0; i < num_objects; i++) {
+		const CellRange& range = mRanges[i];
+		for (int y = range.y0; y <= range.y1; y++) {
+			for (int x = range.x0; x <= range.x1; x++) {
+				mCellStart[Wrap(y, mRows) * mColumns + Wrap(x, mColumns) + 1]++;
+			}
+		}
+	}
+	for (uint cell = 0; cell < num_cells; cell++) mCellStart[cell + 1] += mCellStart[cell];
+	uint* cell_end = arena.Allocate<uint>(num_cells);
+	for (uint cell = 0; cell < num_cells; cell++) cell_end[cell] = mCellStart[cell];
+	mCellObjects = arena.Allocate<uint>(mCellStart[num_cells]);
+	for (uint i = 0; i < num_objects; i++) {
+		const CellRange& range = mRanges[i];
+		for (int y = range.y0; y <= range.y1; y++) {
+			for (int x = range.x0; x <= range.x1; x++) {
+				mCellObjects[cell_end[Wrap(y, mRows) * mColumns + Wrap(x, mColumns)]++] = i;
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#ifndef __COLLISIONGRID_H__
+#define __COLLISIONGRID_H__
+
+#include "GameUtil.h"
+#include "FrameArena.h"
+
+class GameObject;
+class GameWorld;
+
+// Uniform grid broad phase for the world's collision pass. Every object
+// with a bounding shape is entered in each cell overlapped by its bounds
+// over the last update, and the grid wraps at the world's edges like the
+// world does. Only objects sharing a cell need to be tested against each
+// other. The grid is rebuilt in the world's frame arena on every pass.
+class CollisionGrid
+{
+public:
+	CollisionGrid();
+
+	void Build(FrameArena& arena, const shared_ptr<GameObject>* const* objects, uint num_objects, const GameWorld& world, float area = 0);
+
+	uint GetNumCells() const { return mColumns * mRows; }
+	uint GetCellSize(uint cell) const { return mCellStart[cell + 1] - mCellStart[cell]; }
+	const uint* GetCellObjects(uint cell) const { return mCellObjects + mCellStart[cell]; }
+
+	bool IsFirstSharedCell(uint cell, uint i, uint j) const;
+
+private:
+	// The area an object covers; objects with invalid bounds aren't entered
+	struct Bounds
+	{
+		float x0;
+		float y0;
+		float x1;
+		float y1;
+		bool valid;
+	};
+
+	// The cells overlapped by an object's bounds. Coordinates are not
+	// wrapped, so a range may start below zero or end past the last row or
+	// column; empty for objects that take no part in collisions.
+	struct CellRange
+	{
+		int x0;
+		int y0;
+		int x1;
+		int y1;
+	};
+
+	void BuildFromBounds(FrameArena& arena, const Bounds* bounds, uint num_objects, uint num_valid, float max_size, float area, const GameWorld& world);
+
+	int GetColumn(float x) const { return (int)floor((x + mWidth / 2) / mCellWidth); }
+	int GetRow(float y) const { return (int)floor((y + mHeight / 2) / mCellHeight); }
+	static int Wrap(int i, int n) { return ((i % n) + n) % n; }
+	static bool InRange(int i, int first, int last, int n) { return Wrap(i - first, n) <= last - first; }
+
+	float mWidth;
+	float mHeight;
+	float mCellWidth;
+	float mCellHeight;
+	int mColumns;
+	int mRows;
+
+	CellRange* mRanges;
+	// Objects in each cell, in index order. A cell's objects start at
+	// mCellStart[cell] and end at mCellStart[cell + 1].
+	uint* mCellStart;
+	uint* mCellObjects;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __CONTACT_H__
+#define __CONTACT_H__
+
+#include "GameUtil.h"
+
+class GameObject;
+
+// One side of a collision found by the world: the object the contact is
+// delivered to, the object it collided with and how they overlap
+struct Contact
+{
+	GameObject* object;
+	GameObject* other;
+	// Unit vector pointing from object towards other
+	GLVector3f normal;
+	// Distance the objects' bounding shapes overlap by, measured at the
+	// time of impact
+	float depth;
+	// Fraction of the update at which the objects first touched, where 1
+	// is the end of the update
+	float time_of_impact;
+};
+
+// A contiguous run of contacts, either those delivered to one object or a
+// whole batch for one type of object. The contacts live in the world's
+// frame arena, so a span is only valid until the world's next update.
+class ContactSpan
+{
+public:
+	ContactSpan() : mContacts(NULL), mSize(0) {}
+	ContactSpan(const Contact* contacts, uint size) : mContacts(contacts), mSize(size) {}
+
+	const Contact* begin() const { return mContacts; }
+	const Contact* end() const { return mContacts + mSize; }
+	const Contact& operator[](uint i) const { return mContacts[i]; }
+	uint size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+private:
+	const Contact* mContacts;
+	uint mSize;
+};
+
+#endif
@@ -9,7 +9,7 @@ Explosion::Explosion() : GameObject("Explosion") {}
 
 /** Construct a new explosion with given position, velocity, angle and rotation. */
 Explosion::Explosion(GLVector3f p, GLVector3f v, GLfloat h, GLfloat r)
-: GameObject("Explosion", p, v, GLVector3f(), h, r) {}
+: GameObject("Explosion", p, v, GLVector3f(0, 0, 0), h, r) {}
 
 /** Copy constructor. */
 Explosion::Explosion(const Explosion& e) : GameObject(e) {}
@@ -19,16 +19,25 @@ Explosion::~Explosion(void) {}
 
 // PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
 
-/** Update explosion, removing it from game world if necessary. */
-void Explosion::Update(int t)
+/** Advance the explosion's animation, removing it from game world once
+	the animation has finished. Clocked sprites aren't updated, and tell
+	the explosion when they finish instead. */
+void Explosion::UpdateAnimation(int t)
 {
-	// Update position/velocity
-	GameObject::Update(t);
+	if (mSprite.get() == NULL || mSprite->IsClocked()) return;
 
-	if (mSprite.get() == NULL) return;
+	// Update sprite
+	GameObject::UpdateAnimation(t);
 
 	// If sprite has finished animation remove explosion from world
 	if (!mSprite->IsAnimating()) {
 		if (mWorld) mWorld->FlagForRemoval(GetThisPtr());
 	}
 }
+
+/** Remove the explosion from the game world once its clocked sprite has
+	finished. */
+void Explosion::OnSpriteFinished()
+{
+	if (mWorld) mWorld->FlagForRemoval(GetThisPtr());
+}
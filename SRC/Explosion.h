@@ -12,7 +12,8 @@ public:
 	Explosion(const Explosion& e);
 	virtual ~Explosion(void);
 
-	virtual void Update(int t);
+	virtual void UpdateAnimation(int t);
+	virtual void OnSpriteFinished();
 };
 
 #endif
@@ -0,0 +1,52 @@
+#include "FastTrig.h"
+
+// SSE2 is always there on x64, and on x86 when the compiler is told to use it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FASTTRIG_USE_SSE
+#include <emmintrin.h>
+#endif
+
+/** Get the sines and cosines of a run of angles in degrees. The steps are
+	the same as for a single angle, in the same order, with the quadrant
+	picked by masks rather than a switch. */
+void SinCosDegrees(const float* degrees, float* s, float* c, uint n)
+{
+	uint i = 0;
+#ifdef FASTTRIG_USE_SSE
+	const __m128 ninety = _mm_set1_ps(90);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 one = _mm_set1_ps(1);
+	const __m128 to_radians = _mm_set1_ps((float)DEG2RAD);
+	const __m128i int_one = _mm_set1_epi32(1);
+	const __m128i int_two = _mm_set1_epi32(2);
+	for (; i + 4 <= n; i += 4) {
+		__m128 d = _mm_loadu_ps(degrees + i);
+		// Round to the nearest multiple of 90 by truncating and stepping
+		// down where that rounded a negative value up
+		__m128 v = _mm_add_ps(_mm_div_ps(d, ninety), half);
+		__m128 q = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+		q = _mm_sub_ps(q, _mm_and_ps(_mm_cmpgt_ps(q, v), one));
+		__m128i quadrant = _mm_cvttps_epi32(q);
+
+		__m128 x = _mm_mul_ps(_mm_sub_ps(d, _mm_mul_ps(q, ninety)), to_radians);
+		__m128 x2 = _mm_mul_ps(x, x);
+		__m128 sp = _mm_add_ps(_mm_set1_ps(SINCOS_S2), _mm_mul_ps(x2, _mm_set1_ps(SINCOS_S3)));
+		sp = _mm_add_ps(_mm_set1_ps(SINCOS_S1), _mm_mul_ps(x2, sp));
+		__m128 sx = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), sp));
+		__m128 cp = _mm_add_ps(_mm_set1_ps(SINCOS_C2), _mm_mul_ps(x2, _mm_set1_ps(SINCOS_C3)));
+		cp = _mm_add_ps(_mm_set1_ps(SINCOS_C1), _mm_mul_ps(x2, cp));
+		__m128 cx = _mm_add_ps(_mm_sub_ps(one, _mm_mul_ps(half, x2)), _mm_mul_ps(_mm_mul_ps(x2, x2), cp));
+
+		// Odd quadrants swap the sine and cosine; the sine is negative in
+		// quadrants 2 and 3, the cosine in quadrants 1 and 2
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, int_one), int_one));
+		__m128 ss = _mm_or_ps(_mm_and_ps(swap, cx), _mm_andnot_ps(swap, sx));
+		__m128 cc = _mm_or_ps(_mm_and_ps(swap, sx), _mm_andnot_ps(swap, cx));
+		__m128 s_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, int_two), 30));
+		__m128 c_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, int_one), int_two), 30));
+		_mm_storeu_ps(s + i, _mm_xor_ps(ss, s_sign));
+		_mm_storeu_ps(c + i, _mm_xor_ps(cc, c_sign));
+	}
+#endif
+	for (; i < n; i++) SinCosDegrees(degrees[i], s[i], c[i]);
+}
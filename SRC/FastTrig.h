@@ -0,0 +1,42 @@
+#ifndef __FASTTRIG_H__
+#define __FASTTRIG_H__
+
+#include "GameUtil.h"
+
+// Sine and cosine of angles in degrees, worked out in single precision
+// without going through the standard library's double precision functions.
+// The angle is brought to within 45 degrees of a multiple of 90, which is
+// exact in degrees, and polynomials fitted over that range give the sine and
+// cosine. Both are within 1e-7 of the true values (about one unit in the last
+// place near 1) for angles up to a million degrees either way.
+
+// Polynomial coefficients for sin(x) and cos(x) on [-pi/4, pi/4]
+static const float SINCOS_S1 = -1.6666654611e-1f;
+static const float SINCOS_S2 = 8.3321608736e-3f;
+static const float SINCOS_S3 = -1.9515295891e-4f;
+static const float SINCOS_C1 = 4.166664568298827e-2f;
+static const float SINCOS_C2 = -1.388731625493765e-3f;
+static const float SINCOS_C3 = 2.443315711809948e-5f;
+
+/** Get the sine and cosine of an angle in degrees. */
+inline void SinCosDegrees(float degrees, float& s, float& c)
+{
+	float q = floor(degrees / 90 + 0.5f);
+	float x = (degrees - q * 90) * (float)DEG2RAD;
+	float x2 = x * x;
+	float sx = x + x * x2 * (SINCOS_S1 + x2 * (SINCOS_S2 + x2 * SINCOS_S3));
+	float cx = 1 - 0.5f * x2 + x2 * x2 * (SINCOS_C1 + x2 * (SINCOS_C2 + x2 * SINCOS_C3));
+	switch ((int)q & 3) {
+	case 0: s = sx; c = cx; break;
+	case 1: s = cx; c = -sx; break;
+	case 2: s = -sx; c = -cx; break;
+	default: s = -cx; c = sx; break;
+	}
+}
+
+// Get the sines and cosines of a run of angles in degrees. Gives the same
+// results as working them out one at a time, four at once where SSE2 is
+// available.
+void SinCosDegrees(const float* degrees, float* s, float* c, uint n);
+
+#endif
@@ -0,0 +1,79 @@
+#include "FrameArena.h"
+
+using namespace std;
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Construct an arena that grows in blocks of at least the given size.
+	No memory is allocated until the first allocation. */
+FrameArena::FrameArena(size_t block_size)
+	: mCurrentBlock(0),
+	  mOffset(0),
+	  mBlockSize(block_size),
+	  mBytesUsed(0)
+{
+}
+
+/** Destructor. */
+FrameArena::~FrameArena(void)
+{
+	for (size_t i = 0; i < mBlocks.size(); i++) delete[] mBlocks[i].data;
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Allocate the given number of bytes with the given power of two
+	alignment. The memory stays valid until the next Reset(). */
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	// Find room in the current block, moving on to the next one if needed
+	while (mCurrentBlock < mBlocks.size()) {
+		const Block& block = mBlocks[mCurrentBlock];
+		size_t start = (mOffset + alignment - 1) & ~(alignment - 1);
+		if (start + bytes <= block.size) {
+			mOffset = start + bytes;
+			mBytesUsed += bytes;
+			return block.data + start;
+		}
+		mCurrentBlock++;
+		mOffset = 0;
+	}
+
+	AddBlock(bytes + alignment);
+	return Allocate(bytes, alignment);
+}
+
+/** Release everything allocated since the last reset. If the frame needed
+	more than one block they are merged into one, so a steady workload
+	settles on a single block and never allocates from the heap. */
+void FrameArena::Reset(void)
+{
+	if (mBlocks.size() > 1) {
+		size_t capacity = GetCapacity();
+		for (size_t i = 0; i < mBlocks.size(); i++) delete[] mBlocks[i].data;
+		mBlocks.clear();
+		AddBlock(capacity);
+	}
+	mCurrentBlock = 0;
+	mOffset = 0;
+	mBytesUsed = 0;
+}
+
+/** Get the total size of all blocks owned by the arena. */
+size_t FrameArena::GetCapacity(void) const
+{
+	size_t capacity = 0;
+	for (size_t i = 0; i < mBlocks.size(); i++) capacity += mBlocks[i].size;
+	return capacity;
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Append a block of at least the given size. */
+void FrameArena::AddBlock(size_t min_size)
+{
+	Block block;
+	block.size = min_size > mBlockSize ? min_size : mBlockSize;
+	block.data = new uchar[block.size];
+	mBlocks.push_back(block);
+}
@@ -0,0 +1,54 @@
+#ifndef __FRAMEARENA_H__
+#define __FRAMEARENA_H__
+
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+typedef unsigned char uchar;
+
+// Linear allocator for data that only lives until the end of a frame.
+// Allocating bumps a pointer and Reset() releases everything at once.
+// Destructors are never run, so only trivially destructible types may
+// be allocated.
+class FrameArena
+{
+public:
+	FrameArena(size_t block_size = 64 * 1024);
+	~FrameArena(void);
+
+	void* Allocate(size_t bytes, size_t alignment = 16);
+
+	/** Allocate uninitialised space for count objects of type T. */
+	template <class T> T* Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+		return (T*)Allocate(count * sizeof(T), alignof(T));
+	}
+
+	void Reset(void);
+
+	size_t GetBytesUsed(void) const { return mBytesUsed; }
+	size_t GetCapacity(void) const;
+
+private:
+	FrameArena(const FrameArena&);
+	FrameArena& operator=(const FrameArena&);
+
+	struct Block
+	{
+		uchar* data;
+		size_t size;
+	};
+
+	void AddBlock(size_t min_size);
+
+	std::vector<Block> mBlocks;
+	// Block being allocated from and the offset of its first free byte
+	size_t mCurrentBlock;
+	size_t mOffset;
+	size_t mBlockSize;
+	size_t mBytesUsed;
+};
+
+#endif
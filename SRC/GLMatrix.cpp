@@ -45,50 +45,6 @@ template <>
 void GLMatrix<GLfloat>::glGet(GLenum pname)
 { ::glGetFloatv(pname,m); }
 
-template<>
-GLMatrix<GLdouble> GLMatrix<GLdouble>::glScale(GLdouble _x, GLdouble _y, GLdouble _z)
-{
-    GLMatrix<GLdouble> ret;
-    ret.m0 = _x;    ret.m4 = 0;     ret.m8 = 0;     ret.m12 = 0;
-    ret.m1 = 0;     ret.m5 = _y;    ret.m9 = 0;     ret.m13 = 0;
-    ret.m2 = 0;     ret.m6 = 0;     ret.m10 = _z;   ret.m14 = 0;
-    ret.m3 = 0;     ret.m7 = 0;     ret.m11 = 0;    ret.m15 = 1;
-    return ret;
-}
-
-template<>
-GLMatrix<GLfloat> GLMatrix<GLfloat>::glScale(GLfloat _x, GLfloat _y, GLfloat _z)
-{
-    GLMatrix<GLfloat> ret;
-    ret.m0 = _x;    ret.m4 = 0;     ret.m8 = 0;     ret.m12 = 0;
-    ret.m1 = 0;     ret.m5 = _y;    ret.m9 = 0;     ret.m13 = 0;
-    ret.m2 = 0;     ret.m6 = 0;     ret.m10 = _z;   ret.m14 = 0;
-    ret.m3 = 0;     ret.m7 = 0;     ret.m11 = 0;    ret.m15 = 1;
-    return ret;
-}
-
-template<>
-GLMatrix<GLdouble> GLMatrix<GLdouble>::glTranslate(GLdouble _x, GLdouble _y, GLdouble _z)
-{
-    GLMatrix<GLdouble> ret;
-    ret.m0 = 1; ret.m4 = 0; ret.m8 = 0;  ret.m12 = _x;
-    ret.m1 = 0; ret.m5 = 1; ret.m9 = 0;  ret.m13 = _y;
-    ret.m2 = 0; ret.m6 = 0; ret.m10 = 1; ret.m14 = _z;
-    ret.m3 = 0; ret.m7 = 0; ret.m11 = 0; ret.m15 = 1;
-    return ret;
-}
-
-template<>
-GLMatrix<GLfloat> GLMatrix<GLfloat>::glTranslate(GLfloat _x, GLfloat _y, GLfloat _z)
-{
-    GLMatrix<GLfloat> ret;
-    ret.m0 = 1; ret.m4 = 0; ret.m8 = 0;  ret.m12 = _x;
-    ret.m1 = 0; ret.m5 = 1; ret.m9 = 0;  ret.m13 = _y;
-    ret.m2 = 0; ret.m6 = 0; ret.m10 = 1; ret.m14 = _z;
-    ret.m3 = 0; ret.m7 = 0; ret.m11 = 0; ret.m15 = 1;
-    return ret;
-}
-
 template<>
 GLMatrix<GLdouble> GLMatrix<GLdouble>::glRotate(GLdouble angle, GLdouble x, GLdouble y, GLdouble z)
 {
@@ -29,29 +29,30 @@ class GLMatrix
 {
 public:
     //!Create an uninitialised matrix
-    GLMatrix()
-    { }
+    GLMatrix() = default;
 
     //!Create an initialised matrix
-    GLMatrix(T val)
-    { m0=m1=m2=m3=m4=m5=m6=m7=m8=m9=m10=m11=m12=m13=m14=m15=val; }
+    constexpr GLMatrix(T val)
+        : m0(val), m1(val), m2(val), m3(val), m4(val), m5(val), m6(val), m7(val),
+          m8(val), m9(val), m10(val), m11(val), m12(val), m13(val), m14(val), m15(val)
+    { }
 
     //!Create a matrix from an array*/
-    GLMatrix(const T* val)
-    { memmove(m,val,16*sizeof(T)); }
-
-    //!Copy a matrix
-    GLMatrix(const GLMatrix& mat)
-    { memmove(m,mat.m,16*sizeof(T)); }
-
+    constexpr GLMatrix(const T* val)
+        : m0(val[0]), m1(val[1]), m2(val[2]), m3(val[3]), m4(val[4]), m5(val[5]), m6(val[6]), m7(val[7]),
+          m8(val[8]), m9(val[9]), m10(val[10]), m11(val[11]), m12(val[12]), m13(val[13]), m14(val[14]), m15(val[15])
+    { }
 
-    //!Default destructor
-    ~GLMatrix()
-    {}
+    //!Create a matrix from values, column by column
+    constexpr GLMatrix(T v0, T v1, T v2, T v3, T v4, T v5, T v6, T v7,
+                       T v8, T v9, T v10, T v11, T v12, T v13, T v14, T v15)
+        : m0(v0), m1(v1), m2(v2), m3(v3), m4(v4), m5(v5), m6(v6), m7(v7),
+          m8(v8), m9(v9), m10(v10), m11(v11), m12(v12), m13(v13), m14(v14), m15(v15)
+    { }
 
-    //!Assign this matrix from another one
-    inline GLMatrix& operator= (const GLMatrix& mat)
-    { memmove(m,mat.m,16*sizeof(T)); return *this; }
+    //! implicit casting to a const pointer, column major
+    inline operator const T* (void) const
+    {   return m; }
 
     //!Multiply this matrix by a scalar
     inline GLMatrix& operator*= (T val)
@@ -70,7 +71,7 @@ public:
     { for(register unsigned i = 0; i < 16; ++i) m[i] -= mat.m[i]; return *this; }
 
     //!Get the matrix dot product, most commonly used form of matrix multiplication
-    inline GLMatrix operator* (const GLMatrix& mat)
+    inline GLMatrix operator* (const GLMatrix& mat) const
     {
         GLMatrix ret;
         for(register unsigned j = 0; j < 4; ++j)
@@ -151,7 +152,7 @@ public:
     }
 
     //!Get the matrix vector dot product, used to transform vertecies
-    inline GLVector4<T> operator* (const GLVector4<T>& vec)
+    inline GLVector4<T> operator* (const GLVector4<T>& vec) const
     {
         GLVector4<T> ret;
         for(register unsigned j = 0; j < 4; ++j)
@@ -165,7 +166,7 @@ public:
     }
 
     //!Get the matrix vector dot4 product, used to transform vertecies
-    inline GLVector4<T> operator* (const T* v_arr)
+    inline GLVector4<T> operator* (const T* v_arr) const
     {
         GLVector4<T> ret;
         for(register unsigned j = 0; j < 4; ++j)
@@ -259,7 +260,7 @@ public:
     }
 
     //!Get the matrix vector dot product with w = 1, use for transforming non 4D vectors*/
-    inline GLVector3<T> operator* (const GLVector3<T>& vec)
+    inline GLVector3<T> operator* (const GLVector3<T>& vec) const
     {
         GLVector3<T> ret(T(0));
         for(register unsigned j = 0; j < 3; ++j)
@@ -282,6 +283,43 @@ public:
         return ret;
     }
 
+    //!Transform a run of 2D points with z = 0 and w = 1, disregarding w scaling,
+    //!for affine matrices. The points may be transformed in place.
+    void transformPoints(const GLVector2<T>* in, GLVector2<T>* out, unsigned num) const
+    {
+        for(register unsigned k = 0; k < num; ++k)
+        {
+            T x = in[k].x, y = in[k].y;
+            out[k].x = x*m0 + y*m4 + m12;
+            out[k].y = x*m1 + y*m5 + m13;
+        }
+    }
+
+    //!Transform a run of points with w = 1, doing w scaling. The points may be
+    //!transformed in place.
+    void transformPoints(const GLVector3<T>* in, GLVector3<T>* out, unsigned num) const
+    {
+        for(register unsigned k = 0; k < num; ++k)
+        {
+            T x = in[k].x, y = in[k].y, z = in[k].z;
+            register T resip = 1/(x*m3 + y*m7 + z*m11 + m15);
+            out[k].x = (x*m0 + y*m4 + z*m8 + m12)*resip;
+            out[k].y = (x*m1 + y*m5 + z*m9 + m13)*resip;
+            out[k].z = (x*m2 + y*m6 + z*m10 + m14)*resip;
+        }
+    }
+
+    //!Transform a run of 4D vectors. The vectors may be transformed in place.
+    void transformVectors(const GLVector4<T>* in, GLVector4<T>* out, unsigned num) const
+    {
+        for(register unsigned k = 0; k < num; ++k)
+        {
+            T x = in[k].x, y = in[k].y, z = in[k].z, w = in[k].w;
+            for(register unsigned j = 0; j < 4; ++j)
+                out[k].val[j] = x*m[j] + y*m[j+4] + z*m[j+8] + w*m[j+12];
+        }
+    }
+
     //!Transform the vertex and send it to OpenGL*/
     inline void glVertex3v(const T* v_arr)
     {
@@ -345,16 +383,12 @@ public:
 
     //!Special glMatricies
     //!Identity matrix
-    static GLMatrix identity(void)
+    static constexpr GLMatrix identity(void)
     {
-        GLMatrix ret;
-
-        ret.m0 = 1;   ret.m4 = 0;   ret.m8  = 0;  ret.m12 = 0;
-        ret.m1 = 0;   ret.m5 = 1;   ret.m9  = 0;  ret.m13 = 0;
-        ret.m2 = 0;   ret.m6 = 0;   ret.m10 = 1;  ret.m14 = 0;
-        ret.m3 = 0;   ret.m7 = 0;   ret.m11 = 0;  ret.m15 = 1;
-
-        return ret;
+        return GLMatrix(1, 0, 0, 0,
+                        0, 1, 0, 0,
+                        0, 0, 1, 0,
+                        0, 0, 0, 1);
     }
 
     //!Make this an identity matrix
@@ -540,7 +574,13 @@ public:
 
 
     //!OpenGL scale matrix
-    static GLMatrix glScale(T x, T y, T z);
+    static constexpr GLMatrix glScale(T x, T y, T z)
+    {
+        return GLMatrix(x, 0, 0, 0,
+                        0, y, 0, 0,
+                        0, 0, z, 0,
+                        0, 0, 0, 1);
+    }
 
     //!Make this an OpenGL scale matrix
     inline GLMatrix& loadScale(T x, T y, T z = 1)
@@ -594,7 +634,13 @@ public:
     }
 
     //!OpenGL translate matrix
-    static GLMatrix glTranslate(T x, T y, T z);
+    static constexpr GLMatrix glTranslate(T x, T y, T z)
+    {
+        return GLMatrix(1, 0, 0, 0,
+                        0, 1, 0, 0,
+                        0, 0, 1, 0,
+                        x, y, z, 1);
+    }
 
     //!Make this an OpenGL translate matrix
     inline GLMatrix& loadTranslate(T x, T y, T z)
@@ -807,6 +853,110 @@ private:
 
 typedef GLMatrix<GLfloat>  GLMatrix4f;
 
+//!The matrix is a plain value that containers may copy as bytes
+static_assert(std::is_trivially_copyable<GLMatrix4f>::value, "GL matrices must be trivially copyable");
+
+#ifdef GLVECTOR_USE_SIMD
+//!SIMD specialisations of the float matrix. Each works a column at a time,
+//!adding the terms in the same order as the templates, so the results are
+//!the same. Only the w of a projective transform of a 3D point is summed in
+//!a different order.
+
+//!Sum the columns of a matrix scaled by the elements of a 4D vector
+inline GLFloat4 glf4Transform(GLFloat4 c0, GLFloat4 c1, GLFloat4 c2, GLFloat4 c3, const float* v)
+{
+    GLFloat4 r = glf4Mul(c0, glf4Splat(v[0]));
+    r = glf4Add(r, glf4Mul(c1, glf4Splat(v[1])));
+    r = glf4Add(r, glf4Mul(c2, glf4Splat(v[2])));
+    return glf4Add(r, glf4Mul(c3, glf4Splat(v[3])));
+}
+
+template <>
+inline GLMatrix<float> GLMatrix<float>::operator* (const GLMatrix<float>& mat) const
+{
+    GLFloat4 c0 = glf4Load(m), c1 = glf4Load(m+4), c2 = glf4Load(m+8), c3 = glf4Load(m+12);
+    GLMatrix<float> ret;
+    glf4Store(ret.m, glf4Transform(c0, c1, c2, c3, mat.m));
+    glf4Store(ret.m+4, glf4Transform(c0, c1, c2, c3, mat.m+4));
+    glf4Store(ret.m+8, glf4Transform(c0, c1, c2, c3, mat.m+8));
+    glf4Store(ret.m+12, glf4Transform(c0, c1, c2, c3, mat.m+12));
+    return ret;
+}
+
+template <>
+inline GLMatrix<float>& GLMatrix<float>::operator*= (const GLMatrix<float>& mat)
+{
+    return *this = (*this) * mat;
+}
+
+template <>
+inline GLVector4<float> GLMatrix<float>::operator* (const GLVector4<float>& vec) const
+{
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Transform(glf4Load(m), glf4Load(m+4), glf4Load(m+8), glf4Load(m+12), vec.val));
+    return ret;
+}
+
+template <>
+inline GLVector3<float> GLMatrix<float>::operator* (const GLVector3<float>& vec) const
+{
+    GLFloat4 r = glf4Mul(glf4Load(m), glf4Splat(vec.x));
+    r = glf4Add(r, glf4Mul(glf4Load(m+4), glf4Splat(vec.y)));
+    r = glf4Add(r, glf4Mul(glf4Load(m+8), glf4Splat(vec.z)));
+    r = glf4Add(r, glf4Load(m+12));
+    float f[4];
+    glf4Store(f, r);
+    register float resip = 1/f[3];
+    return GLVector3<float>(f[0]*resip, f[1]*resip, f[2]*resip);
+}
+
+template <>
+inline void GLMatrix<float>::transformPoints(const GLVector2<float>* in, GLVector2<float>* out, unsigned num) const
+{
+    //two points a register, as x0 y0 x1 y1
+    GLFloat4 cx = glf4Load(GLVector4<float>(m0, m1, m0, m1).val);
+    GLFloat4 cy = glf4Load(GLVector4<float>(m4, m5, m4, m5).val);
+    GLFloat4 ct = glf4Load(GLVector4<float>(m12, m13, m12, m13).val);
+    register unsigned k = 0;
+    for(; k + 2 <= num; k += 2)
+    {
+        GLFloat4 v = glf4Load(in[k].val);
+        GLFloat4 r = glf4Add(glf4Mul(glf4DupEven(v), cx), glf4Mul(glf4DupOdd(v), cy));
+        glf4Store(out[k].val, glf4Add(r, ct));
+    }
+    for(; k < num; ++k)
+    {
+        float x = in[k].x, y = in[k].y;
+        out[k].x = x*m0 + y*m4 + m12;
+        out[k].y = x*m1 + y*m5 + m13;
+    }
+}
+
+template <>
+inline void GLMatrix<float>::transformPoints(const GLVector3<float>* in, GLVector3<float>* out, unsigned num) const
+{
+    GLFloat4 c0 = glf4Load(m), c1 = glf4Load(m+4), c2 = glf4Load(m+8), c3 = glf4Load(m+12);
+    float f[4];
+    for(register unsigned k = 0; k < num; ++k)
+    {
+        GLFloat4 r = glf4Mul(c0, glf4Splat(in[k].x));
+        r = glf4Add(r, glf4Mul(c1, glf4Splat(in[k].y)));
+        r = glf4Add(r, glf4Mul(c2, glf4Splat(in[k].z)));
+        r = glf4Add(r, c3);
+        glf4Store(f, r);
+        glf4Store3(out[k].val, glf4Mul(r, glf4Splat(1/f[3])));
+    }
+}
+
+template <>
+inline void GLMatrix<float>::transformVectors(const GLVector4<float>* in, GLVector4<float>* out, unsigned num) const
+{
+    GLFloat4 c0 = glf4Load(m), c1 = glf4Load(m+4), c2 = glf4Load(m+8), c3 = glf4Load(m+12);
+    for(register unsigned k = 0; k < num; ++k)
+        glf4Store(out[k].val, glf4Transform(c0, c1, c2, c3, in[k].val));
+}
+#endif
+
 
 
 #endif
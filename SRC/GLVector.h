@@ -21,6 +21,7 @@
 #define GL_VECTOR_H
 
 #define GLVECTOR_IOSTREAM
+#define GLVECTOR_SIMD
 
 #include <GL/glut.h>
 #include <cmath>
@@ -28,6 +29,74 @@
     #include <iostream>
 #endif
 #include <cstring>
+#include <type_traits>
+
+//!SIMD versions of the float vectors and matrices, enable by defining GLVECTOR_SIMD
+//!SSE2 is always there on x64, and on x86 when the compiler is told to use it.
+//!NEON is only used on AArch64, which has the vector divide normalize needs.
+#ifdef GLVECTOR_SIMD
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define GLVECTOR_USE_SSE
+        #include <emmintrin.h>
+    #elif defined(__aarch64__) || defined(_M_ARM64)
+        #define GLVECTOR_USE_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined(GLVECTOR_USE_SSE) || defined(GLVECTOR_USE_NEON)
+#define GLVECTOR_USE_SIMD
+
+//!Four floats in a SIMD register, with the few operations the float
+//!specialisations need. Every operation rounds each lane exactly as the
+//!scalar one would, so the specialisations give the same results as the
+//!templates they replace.
+#ifdef GLVECTOR_USE_SSE
+typedef __m128 GLFloat4;
+
+inline GLFloat4 glf4Load(const float* p) { return _mm_loadu_ps(p); }
+inline void glf4Store(float* p, GLFloat4 v) { _mm_storeu_ps(p, v); }
+inline GLFloat4 glf4Splat(float f) { return _mm_set1_ps(f); }
+inline GLFloat4 glf4Add(GLFloat4 a, GLFloat4 b) { return _mm_add_ps(a, b); }
+inline GLFloat4 glf4Sub(GLFloat4 a, GLFloat4 b) { return _mm_sub_ps(a, b); }
+inline GLFloat4 glf4Mul(GLFloat4 a, GLFloat4 b) { return _mm_mul_ps(a, b); }
+inline GLFloat4 glf4Div(GLFloat4 a, GLFloat4 b) { return _mm_div_ps(a, b); }
+
+//!Store the first three lanes, without writing past them
+inline void glf4Store3(float* p, GLFloat4 v)
+{   _mm_storel_pi((__m64*)p, v); _mm_store_ss(p + 2, _mm_movehl_ps(v, v)); }
+
+//!Lanes 0, 0, 2, 2 and 1, 1, 3, 3, to work on pairs of 2D points
+inline GLFloat4 glf4DupEven(GLFloat4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0)); }
+inline GLFloat4 glf4DupOdd(GLFloat4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1)); }
+#else
+typedef float32x4_t GLFloat4;
+
+inline GLFloat4 glf4Load(const float* p) { return vld1q_f32(p); }
+inline void glf4Store(float* p, GLFloat4 v) { vst1q_f32(p, v); }
+inline GLFloat4 glf4Splat(float f) { return vdupq_n_f32(f); }
+inline GLFloat4 glf4Add(GLFloat4 a, GLFloat4 b) { return vaddq_f32(a, b); }
+inline GLFloat4 glf4Sub(GLFloat4 a, GLFloat4 b) { return vsubq_f32(a, b); }
+inline GLFloat4 glf4Mul(GLFloat4 a, GLFloat4 b) { return vmulq_f32(a, b); }
+inline GLFloat4 glf4Div(GLFloat4 a, GLFloat4 b) { return vdivq_f32(a, b); }
+
+//!Store the first three lanes, without writing past them
+inline void glf4Store3(float* p, GLFloat4 v)
+{   vst1_f32(p, vget_low_f32(v)); vst1q_lane_f32(p + 2, v, 2); }
+
+//!Lanes 0, 0, 2, 2 and 1, 1, 3, 3, to work on pairs of 2D points
+inline GLFloat4 glf4DupEven(GLFloat4 v) { return vtrn1q_f32(v, v); }
+inline GLFloat4 glf4DupOdd(GLFloat4 v) { return vtrn2q_f32(v, v); }
+#endif
+
+//!Sum the lanes in order, as the scalar dot products do
+inline float glf4Sum(GLFloat4 v)
+{
+    float f[4];
+    glf4Store(f, v);
+    return f[0] + f[1] + f[2] + f[3];
+}
+#endif
 
 //!a 2D vector class for OpenGL
 template <typename T>
@@ -38,27 +107,19 @@ class GLVector2
 public:
 
     //!Create an uninitialised vector
-    GLVector2()
-    { }
+    GLVector2() = default;
 
     //!Create an initialised vector
-    GLVector2(T v)
-    {   x = y = v; }
+    constexpr GLVector2(T v)
+        : x(v), y(v) { }
 
     //!Create an initialised vector from values
-    GLVector2(T v1, T v2)
-    {   x = v1; y = v2; }
-
-    //!Copy a vector
-    GLVector2(const GLVector2& gv)
-    {   memmove(val,gv.val,D*sizeof(T)); }
+    constexpr GLVector2(T v1, T v2)
+        : x(v1), y(v2) { }
 
     //!Create a vector from an array
-    GLVector2(const T* f)
-    {   memmove(val,f,D*sizeof(T)); }
-
-    //!Default destructor
-    ~GLVector2(){}
+    constexpr GLVector2(const T* f)
+        : x(f[0]), y(f[1]) { }
 
     //! element by element initialiser
     inline void set(const T& v1, const T& v2)
@@ -92,43 +153,43 @@ public:
     {   memmove(vec,val,2*sizeof(T)); }
 
     //!Get the sum of this and a vector
-    inline const GLVector2 operator + (const GLVector2 gv) const
+    constexpr const GLVector2 operator + (const GLVector2 gv) const
     {
         return GLVector2(x+gv.x,y+gv.y);
     }
 
     //!Get the difference of this and a vector
-    inline const GLVector2 operator - (const GLVector2 gv) const
+    constexpr const GLVector2 operator - (const GLVector2 gv) const
     {
         return GLVector2(x-gv.x,y-gv.y);
     }
 
     //!Get the element-by-element product of this and a vector
-    inline const GLVector2 operator * (const GLVector2 gv) const
+    constexpr const GLVector2 operator * (const GLVector2 gv) const
     {
         return GLVector2(x*gv.x,y*gv.y);
     }
 
     //!Get the element-by-element quota of this and a vector
-    inline const GLVector2 operator / (const GLVector2 gv) const
+    constexpr const GLVector2 operator / (const GLVector2 gv) const
     {
         return GLVector2(x/gv.x,y/gv.y);
     }
 
     //!Get the element-by-element product of this and a scalar
-    inline const GLVector2 operator * (const T& v) const
+    constexpr const GLVector2 operator * (const T& v) const
     {
         return GLVector2(x*v,y*v);
     }
 
     //!Get the element-by-element quota of this and a scalar
-    inline const GLVector2 operator / (const T& v) const
+    constexpr const GLVector2 operator / (const T& v) const
     {
         return GLVector2(x/v,y/v);
     }
 
     //!Add a vector to this
-    GLVector2& operator += (const GLVector2 gv)
+    constexpr GLVector2& operator += (const GLVector2 gv)
     {
         x += gv.x;
         y += gv.y;
@@ -136,7 +197,7 @@ public:
     }
 
     //!Subtract a vector from this
-    GLVector2& operator -= (const GLVector2 gv)
+    constexpr GLVector2& operator -= (const GLVector2 gv)
     {
         x -= gv.x;
         y -= gv.y;
@@ -144,7 +205,7 @@ public:
     }
 
     //!Multiply this by a scalar
-    GLVector2& operator *= (const T f)
+    constexpr GLVector2& operator *= (const T f)
     {
         x *= f;
         y *= f;
@@ -152,25 +213,21 @@ public:
     }
 
     //!Divide this by a scalar
-    GLVector2& operator /= (const T f)
+    constexpr GLVector2& operator /= (const T f)
     {
         x /= f;
         y /= f;
         return *this;
     }
 
-    //!copy this from a vector
-    GLVector2& operator = ( const GLVector2& v )
-    {   memmove(val, v.val, D*sizeof(T)); return *this; }
-
     //!negate this
-    inline const GLVector2 operator - () const
+    constexpr const GLVector2 operator - () const
     {
         return GLVector2(-x,-y);
     }
 
     //!Get the dot product of this and a vector
-    inline const T dot(const GLVector2& gv) const
+    constexpr T dot(const GLVector2& gv) const
     {   return x*gv.x + y*gv.y; }
 
     //!Get the length of this
@@ -178,7 +235,7 @@ public:
     {   return sqrt(lengthSqr()); }
 
     //!Get the length squared, less computation than length()
-    inline T lengthSqr() const
+    constexpr T lengthSqr() const
     {   return x * x + y * y; }
 
     //!Get the the unit vector of this
@@ -195,15 +252,15 @@ public:
     }
 
     //!Get the projection of this and a vector
-    inline const T projection(GLVector2 in) const
+    constexpr const T projection(GLVector2 in) const
     {   return dot(in); }
 
     //!Get the orthogonal projection of this and a vector
-    inline GLVector2 orthogonalProjection(const GLVector2& in) const
+    constexpr GLVector2 orthogonalProjection(const GLVector2& in) const
     {   return in - vectorProjection(in); }
 
     //!Get the vector projection of this and a vector
-    GLVector2 vectorProjection(const GLVector2& in) const
+    constexpr GLVector2 vectorProjection(const GLVector2& in) const
     {   return (*this) * dot(in); }
 
     #ifdef GLVECTOR_IOSTREAM
@@ -251,27 +308,19 @@ class GLVector3
 public:
 
     //!Create an uninitialised vector
-    GLVector3()
-    { }
+    GLVector3() = default;
 
     //!Create an initialised vector
-    GLVector3(T v)
-    {   x = y = z = v; }
+    constexpr GLVector3(T v)
+        : x(v), y(v), z(v) { }
 
     //!Create an initialised vector from values
-    GLVector3(T v1, T v2, T v3)
-    {   x = v1; y = v2; z = v3; }
-
-    //!Copy a vector
-    GLVector3(const GLVector3& gv)
-    {   memmove(val,gv.val,D*sizeof(T)); }
+    constexpr GLVector3(T v1, T v2, T v3)
+        : x(v1), y(v2), z(v3) { }
 
     //!Create a vector from an array
-    GLVector3(const T* f)
-    {   memmove(val,f,D*sizeof(T)); }
-
-    //!Default destructor
-    ~GLVector3(){}
+    constexpr GLVector3(const T* f)
+        : x(f[0]), y(f[1]), z(f[2]) { }
 
     //! element by element initialiser
     inline void set(const T& v1, const T& v2, const T& v3)
@@ -305,44 +354,44 @@ public:
     {   memmove(vec,val,D*sizeof(T)); }
 
     //!Get the sum of this and a vector
-    inline const GLVector3 operator + (const GLVector3 gv) const
+    constexpr const GLVector3 operator + (const GLVector3 gv) const
     {
         return GLVector3(x+gv.x,y+gv.y,z+gv.z);
     }
 
     //!Get the difference of this and a vector
-    inline const GLVector3 operator - (const GLVector3 gv) const
+    constexpr const GLVector3 operator - (const GLVector3 gv) const
     {
         return GLVector3(x-gv.x,y-gv.y,z-gv.z);
     }
 
     //!Get the element-by-element product of this and a vector
-    inline const GLVector3 operator * (const GLVector3 gv) const
+    constexpr const GLVector3 operator * (const GLVector3 gv) const
     {
         return GLVector3(x*gv.x,y*gv.y,z*gv.z);
     }
 
     //!Get the element-by-element quota of this and a vector
-    inline const GLVector3 operator / (const GLVector3 gv) const
+    constexpr const GLVector3 operator / (const GLVector3 gv) const
     {
         return GLVector3(x/gv.x,y/gv.y,z/gv.z);
     }
 
     //!Get the element-by-element product of this and a scalar
-    inline const GLVector3 operator * (const T& v) const
+    constexpr const GLVector3 operator * (const T& v) const
     {
         return GLVector3(x*v,y*v,z*v);
     }
 
 
     //!Get the element-by-element quota of this and a scalar
-    inline const GLVector3 operator / (const T& v) const
+    constexpr const GLVector3 operator / (const T& v) const
     {
         return GLVector3(x/v,y/v,z/v);
     }
 
     //!Add a vector to this
-    GLVector3& operator += (const GLVector3 gv)
+    constexpr GLVector3& operator += (const GLVector3 gv)
     {
         x += gv.x;
         y += gv.y;
@@ -351,7 +400,7 @@ public:
     }
 
     //!Subtract a vector from this
-    GLVector3& operator -= (const GLVector3 gv)
+    constexpr GLVector3& operator -= (const GLVector3 gv)
     {
         x -= gv.x;
         y -= gv.y;
@@ -360,7 +409,7 @@ public:
     }
 
     //!Multiply this by a scalar
-    GLVector3& operator *= (const T f)
+    constexpr GLVector3& operator *= (const T f)
     {
         x *= f;
         y *= f;
@@ -369,7 +418,7 @@ public:
     }
 
     //!Divide this by a scalar
-    GLVector3& operator /= (const T f)
+    constexpr GLVector3& operator /= (const T f)
     {
         x /= f;
         y /= f;
@@ -377,23 +426,14 @@ public:
         return *this;
     }
 
-    //!copy this from a vector
-    GLVector3& operator = ( const GLVector3& gv )
-    {
-        x = gv.x;
-        y = gv.y;
-        z = gv.z;
-        return *this;
-    }
-
     //!negate this
-    inline const GLVector3 operator - () const
+    constexpr const GLVector3 operator - () const
     {
         return GLVector3(-x,-y,-z);
     }
 
     //!Get the dot product of this and a vector
-    inline const T dot(const GLVector3& gv) const
+    constexpr T dot(const GLVector3& gv) const
     {   return x*gv.x + y*gv.y + z*gv.z;  }
 
     //!Get the length of this
@@ -401,11 +441,11 @@ public:
     {   return sqrt(lengthSqr()); }
 
     //!Get the length squared, less computation than length()
-    inline T lengthSqr() const
+    constexpr T lengthSqr() const
     {   return x*x + y*y + z*z;  }
 
     //!Get the cross-product of this and a vector
-    const GLVector3 getCross(const GLVector3& gv) const
+    constexpr const GLVector3 getCross(const GLVector3& gv) const
     {
         return GLVector3(y*gv.z-z*gv.y,z*gv.x-x*gv.z,x*gv.y-y*gv.x);
     }
@@ -436,15 +476,15 @@ public:
     }
 
     //!Get the projection of this and a vector
-    inline const T projection(GLVector3 in) const
+    constexpr const T projection(GLVector3 in) const
     {   return dot(in); }
 
     //!Get the orthogonal projection of this and a vector
-    inline GLVector3 orthogonalProjection(const GLVector3& in) const
+    constexpr GLVector3 orthogonalProjection(const GLVector3& in) const
     {   return in - (*this) * dot(in); }
 
     //!Get the vector projection of this and a vector
-    GLVector3 vectorProjection(const GLVector3& in) const
+    constexpr GLVector3 vectorProjection(const GLVector3& in) const
     {   return (*this) * dot(in); }
 
     #ifdef GLVECTOR_IOSTREAM
@@ -492,27 +532,19 @@ class GLVector4
 public:
 
     //!Create an uninitialised vector
-    GLVector4()
-    { }
+    GLVector4() = default;
 
     //!Create an initialised vector
-    GLVector4(T v)
-    {   x = y = z = w = v; }
+    constexpr GLVector4(T v)
+        : x(v), y(v), z(v), w(v) { }
 
     //!Create an initialised vector from values
-    GLVector4(T v1, T v2, T v3, T v4)
-    {   x = v1; y = v2; z = v3; w = v4; }
-
-    //!Copy a vector
-    GLVector4(const GLVector4& gv)
-    {   memmove(val,gv.val,D*sizeof(T)); }
+    constexpr GLVector4(T v1, T v2, T v3, T v4)
+        : x(v1), y(v2), z(v3), w(v4) { }
 
     //!Create a vector from an array
-    GLVector4(const T* f)
-    {   memmove(val,f,D*sizeof(T)); }
-
-    //!Default destructor
-    ~GLVector4(){}
+    constexpr GLVector4(const T* f)
+        : x(f[0]), y(f[1]), z(f[2]), w(f[3]) { }
 
     //! element by element initialiser
     inline void set(const T& v1, const T& v2, const T& v3, const T& v4)
@@ -546,44 +578,44 @@ public:
     {   memmove(vec,val,D*sizeof(T)); }
 
     //!Get the sum of this and a vector
-    inline const GLVector4 operator + (const GLVector4 gv) const
+    constexpr const GLVector4 operator + (const GLVector4 gv) const
     {
         return GLVector4(x+gv.x,y+gv.y,z+gv.z,w+gv.w);
     }
 
     //!Get the difference of this and a vector
-    inline const GLVector4 operator - (const GLVector4 gv) const
+    constexpr const GLVector4 operator - (const GLVector4 gv) const
     {
         return GLVector4(x-gv.x,y-gv.y,z-gv.z,w-gv.w);
     }
 
     //!Get the element-by-element product of this and a vector
-    inline const GLVector4 operator * (const GLVector4 gv) const
+    constexpr const GLVector4 operator * (const GLVector4 gv) const
     {
         return GLVector4(x*gv.x,y*gv.y,z*gv.z,w*gv.w);
     }
 
     //!Get the element-by-element quota of this and a vector
-    inline const GLVector4 operator / (const GLVector4 gv) const
+    constexpr const GLVector4 operator / (const GLVector4 gv) const
     {
         return GLVector4(x/gv.x,y/gv.y,z/gv.z,w/gv.w);
     }
 
     //!Get the element-by-element product of this and a scalar
-    inline const GLVector4 operator * (const T& v) const
+    constexpr const GLVector4 operator * (const T& v) const
     {
         return GLVector4(x*v,y*v,z*v,w*v);
     }
 
 
     //!Get the element-by-element quota of this and a scalar
-    inline const GLVector4 operator / (const T& v) const
+    constexpr const GLVector4 operator / (const T& v) const
     {
         return GLVector4(x/v,y/v,z/v,w/v);
     }
 
     //!Add a vector to this
-    GLVector4& operator += (const GLVector4 gv)
+    constexpr GLVector4& operator += (const GLVector4 gv)
     {
         x += gv.x;
         y += gv.y;
@@ -593,7 +625,7 @@ public:
     }
 
     //!Subtract a vector from this
-    GLVector4& operator -= (const GLVector4 gv)
+    constexpr GLVector4& operator -= (const GLVector4 gv)
     {
         x -= gv.x;
         y -= gv.y;
@@ -603,7 +635,7 @@ public:
     }
 
     //!Multiply this by a scalar
-    GLVector4& operator *= (const T f)
+    constexpr GLVector4& operator *= (const T f)
     {
         x *= f;
         y *= f;
@@ -613,7 +645,7 @@ public:
     }
 
     //!Divide this by a scalar
-    GLVector4& operator /= (const T f)
+    constexpr GLVector4& operator /= (const T f)
     {
         x /= f;
         y /= f;
@@ -622,21 +654,14 @@ public:
         return *this;
     }
 
-    //!copy this from a vector
-    GLVector4& operator = ( const GLVector4& gv )
-    {
-        memmove(val,gv.val,D*sizeof(T));
-        return *this;
-    }
-
     //!negate this
-    inline const GLVector4 operator - () const
+    constexpr const GLVector4 operator - () const
     {
         return GLVector4(-x,-y,-z,-w);
     }
 
     //!Get the dot product of this and a vector
-    inline const T dot(const GLVector4& gv) const
+    constexpr T dot(const GLVector4& gv) const
     {   return x*gv.x + y*gv.y + z*gv.z + w*gv.w;  }
 
     //!Get the length of this
@@ -644,11 +669,11 @@ public:
     {   return sqrt(lengthSqr()); }
 
     //!Get the length squared, less computation than length()
-    inline T lengthSqr() const
+    constexpr T lengthSqr() const
     {   return x*x + y*y + z*z + w*w;  }
 
     //!Get the cross-product of this and a vector
-    const GLVector4 getCross(const GLVector4& gv) const
+    constexpr const GLVector4 getCross(const GLVector4& gv) const
     {
         return GLVector4(y*gv.z-z*gv.y,z*gv.w-w*gv.z,w*gv.x-x*gv.w,x*gv.y-y*gv.x);
     }
@@ -680,15 +705,15 @@ public:
     }
 
     //!Get the projection of this and a vector
-    inline const T projection(GLVector4 in) const
+    constexpr const T projection(GLVector4 in) const
     {   return dot(in); }
 
     //!Get the orthogonal projection of this and a vector
-    inline GLVector4 orthogonalProjection(const GLVector4& in) const
+    constexpr GLVector4 orthogonalProjection(const GLVector4& in) const
     {   return in - vectorProjection(in); }
 
     //!Get the vector projection of this and a vector
-    GLVector4 vectorProjection(const GLVector4& in) const
+    constexpr GLVector4 vectorProjection(const GLVector4& in) const
     {   return (*this) * dot(in); }
 
     #ifdef GLVECTOR_IOSTREAM
@@ -726,6 +751,104 @@ typedef GLVector4<GLfloat> GLVector4f;
 //!Corresponds to glVertex4d ...etc
 typedef GLVector4<GLdouble> GLVector4d;
 
+//!The vectors are plain values that containers may copy as bytes
+static_assert(std::is_trivially_copyable<GLVector2f>::value &&
+              std::is_trivially_copyable<GLVector3f>::value &&
+              std::is_trivially_copyable<GLVector4f>::value, "GL vectors must be trivially copyable");
+
+#ifdef GLVECTOR_USE_SIMD
+//!SIMD specialisations of the float vectors. GLVector3f stays three floats
+//!wide, as it is packed into arrays and objects, so it has to be loaded and
+//!stored a lane at a time; that costs as much as its own operations save,
+//!and only the matrix transforms of it are specialised.
+
+template <>
+inline const GLVector4<float> GLVector4<float>::operator + (const GLVector4<float> gv) const
+{
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Add(glf4Load(val), glf4Load(gv.val)));
+    return ret;
+}
+
+template <>
+inline const GLVector4<float> GLVector4<float>::operator - (const GLVector4<float> gv) const
+{
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Sub(glf4Load(val), glf4Load(gv.val)));
+    return ret;
+}
+
+template <>
+inline const GLVector4<float> GLVector4<float>::operator * (const GLVector4<float> gv) const
+{
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Mul(glf4Load(val), glf4Load(gv.val)));
+    return ret;
+}
+
+template <>
+inline const GLVector4<float> GLVector4<float>::operator * (const float& v) const
+{
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Mul(glf4Load(val), glf4Splat(v)));
+    return ret;
+}
+
+template <>
+inline const GLVector4<float> GLVector4<float>::operator / (const float& v) const
+{
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Div(glf4Load(val), glf4Splat(v)));
+    return ret;
+}
+
+template <>
+inline GLVector4<float>& GLVector4<float>::operator += (const GLVector4<float> gv)
+{
+    glf4Store(val, glf4Add(glf4Load(val), glf4Load(gv.val)));
+    return *this;
+}
+
+template <>
+inline GLVector4<float>& GLVector4<float>::operator -= (const GLVector4<float> gv)
+{
+    glf4Store(val, glf4Sub(glf4Load(val), glf4Load(gv.val)));
+    return *this;
+}
+
+template <>
+inline GLVector4<float>& GLVector4<float>::operator *= (const float f)
+{
+    glf4Store(val, glf4Mul(glf4Load(val), glf4Splat(f)));
+    return *this;
+}
+
+template <>
+inline float GLVector4<float>::dot(const GLVector4<float>& gv) const
+{   return glf4Sum(glf4Mul(glf4Load(val), glf4Load(gv.val))); }
+
+template <>
+inline float GLVector4<float>::lengthSqr() const
+{   return dot(*this); }
+
+template <>
+inline const GLVector4<float> GLVector4<float>::unit() const
+{
+    GLFloat4 v = glf4Load(val);
+    GLVector4<float> ret;
+    glf4Store(ret.val, glf4Div(v, glf4Splat(sqrt(glf4Sum(glf4Mul(v, v))))));
+    return ret;
+}
+
+template <>
+inline GLVector4<float>& GLVector4<float>::normalize()
+{
+    GLFloat4 v = glf4Load(val);
+    glf4Store(val, glf4Div(v, glf4Splat(sqrt(glf4Sum(glf4Mul(v, v))))));
+    return *this;
+}
+#endif
+
 
 
 #endif
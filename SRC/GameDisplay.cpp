@@ -1,5 +1,7 @@
 #include "GameUtil.h"
 #include "GUIComponent.h"
+#include "ProfilerOverlay.h"
+#include "Profiler.h"
 #include "GameDisplay.h"
 
 // PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
@@ -24,6 +26,8 @@ GameDisplay::~GameDisplay(void)
 /** Render display by rendering top level container. */
 void GameDisplay::Render(void)
 {
+	PROFILE_SCOPE("GameDisplay::Render");
+
 	// Update the projection matrix
 	glMatrixMode(GL_PROJECTION);
 	// Initialize the projection matrix to the identity matrix
@@ -37,3 +41,20 @@ void GameDisplay::Render(void)
 
 	mContainer.Draw();
 }
+
+/** Show or hide the profiler overlay, turning profiling on while it is shown. */
+void GameDisplay::SetProfilerOverlayVisible(bool visible)
+{
+	if (visible && !mProfilerOverlay) {
+		mProfilerOverlay = make_shared<ProfilerOverlay>();
+		mContainer.AddComponent(mProfilerOverlay, GLVector2f(1.0f, 1.0f));
+	}
+	if (mProfilerOverlay) mProfilerOverlay->SetVisible(visible);
+	Profiler::GetInstance().SetEnabled(visible);
+}
+
+/** Check if the profiler overlay is currently shown. */
+bool GameDisplay::IsProfilerOverlayVisible()
+{
+	return mProfilerOverlay && mProfilerOverlay->GetVisible();
+}
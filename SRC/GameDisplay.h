@@ -4,6 +4,8 @@
 #include "GameUtil.h"
 #include "GUIContainer.h"
 
+class ProfilerOverlay;
+
 class GameDisplay
 {
 public:
@@ -26,11 +28,15 @@ public:
 
 	GUIContainer *GetContainer() { return &mContainer; }
 
+	void SetProfilerOverlayVisible(bool visible);
+	bool IsProfilerOverlayVisible();
+
 protected:
 	int mWidth;
 	int mHeight;
 	
 	GUIContainer mContainer;
+	shared_ptr<ProfilerOverlay> mProfilerOverlay;
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include "GameWorld.h"
 #include "GameObject.h"
-
-bool GameObject::mRenderDebug = false;
+#include "FastTrig.h"
 
 // PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
 
@@ -14,7 +13,23 @@ GameObject::GameObject(char const * const type_name)
 	  mAcceleration(0,0,0),
 	  mAngle(0),
 	  mRotation(0),
-	  mScale(1)
+	  mScale(1),
+	  mHeading(0,0,0),
+	  mHeadingAngle(NAN),
+	  mTransform(GLMatrix4f::identity()),
+	  mTransformPosition(0,0,0),
+	  mTransformAngle(NAN),
+	  mTransformScale(0),
+	  mPreviousPosition(0,0,0),
+	  mFastMover(false),
+	  mAnalyticMotion(false),
+	  mAnchorTime(0),
+	  mUpdateTime(0),
+	  mAnimationTime(0),
+	  mRegion(-1),
+	  mRegionSlot(0),
+	  mSpritePhase(0),
+	  mBatchedSprite(false)
 {
 }
 
@@ -27,7 +42,23 @@ GameObject::GameObject(char const * const type_name, GLVector3f p, GLVector3f v,
 	  mAcceleration(a),
 	  mAngle(h),
 	  mRotation(r),
-	  mScale(1)
+	  mScale(1),
+	  mHeading(0,0,0),
+	  mHeadingAngle(NAN),
+	  mTransform(GLMatrix4f::identity()),
+	  mTransformPosition(0,0,0),
+	  mTransformAngle(NAN),
+	  mTransformScale(0),
+	  mPreviousPosition(p),
+	  mFastMover(false),
+	  mAnalyticMotion(false),
+	  mAnchorTime(0),
+	  mUpdateTime(0),
+	  mAnimationTime(0),
+	  mRegion(-1),
+	  mRegionSlot(0),
+	  mSpritePhase(0),
+	  mBatchedSprite(false)
 {
 }
 
@@ -40,7 +71,23 @@ GameObject::GameObject(const GameObject& o)
 	  mAcceleration(o.mAcceleration),
 	  mAngle(o.mAngle),
 	  mRotation(o.mRotation),
-	  mScale(o.mScale)
+	  mScale(o.mScale),
+	  mHeading(o.mHeading),
+	  mHeadingAngle(o.mHeadingAngle),
+	  mTransform(o.mTransform),
+	  mTransformPosition(o.mTransformPosition),
+	  mTransformAngle(o.mTransformAngle),
+	  mTransformScale(o.mTransformScale),
+	  mPreviousPosition(o.mPreviousPosition),
+	  mFastMover(o.mFastMover),
+	  mAnalyticMotion(o.mAnalyticMotion),
+	  mAnchorTime(o.mAnchorTime),
+	  mUpdateTime(o.mUpdateTime),
+	  mAnimationTime(o.mAnimationTime),
+	  mRegion(-1),
+	  mRegionSlot(0),
+	  mSpritePhase(o.mSpritePhase),
+	  mBatchedSprite(o.mBatchedSprite)
 {
 }
 
@@ -61,41 +108,138 @@ void GameObject::Reset()
 	SetRotation(0);
 }
 
-/** Update this game object by updating position, velocity and angle of object. */
+/** Get a unit vector in the direction this object faces. It is kept from
+	one call to the next and only worked out again when the angle changes. */
+const GLVector3f& GameObject::GetHeading()
+{
+	GLfloat angle = GetAngle();
+	if (angle != mHeadingAngle) {
+		float s, c;
+		SinCosDegrees(angle, s, c);
+		mHeading = GLVector3f(c, s, 0);
+		mHeadingAngle = angle;
+	}
+	return mHeading;
+}
+
+/** Get the matrix that places this object in the world: scaled, turned to
+	its angle and moved to its position. It is kept from one call to the
+	next and only worked out again when one of those changes. */
+const GLMatrix4f& GameObject::GetTransform()
+{
+	GLVector3f position = GetPosition();
+	GLfloat angle = GetAngle();
+	if (position.x != mTransformPosition.x || position.y != mTransformPosition.y || position.z != mTransformPosition.z ||
+		angle != mTransformAngle || mScale != mTransformScale) {
+		const GLVector3f& heading = GetHeading();
+		GLfloat c = heading.x * mScale;
+		GLfloat s = heading.y * mScale;
+		mTransform = GLMatrix4f(c, s, 0, 0,
+								-s, c, 0, 0,
+								0, 0, mScale, 0,
+								position.x, position.y, position.z, 1);
+		mTransformPosition = position;
+		mTransformAngle = angle;
+		mTransformScale = mScale;
+	}
+	return mTransform;
+}
+
+/** Add this game object to a world, or remove it from one with NULL. An
+	object with analytic motion stops moving when it leaves a world and
+	starts again from where it was when it joins one. */
+void GameObject::SetWorld(GameWorld *w)
+{
+	Reanchor();
+	mWorld = w;
+	if (mWorld == NULL) return;
+	mAnchorTime = mWorld->GetTime();
+	mUpdateTime = mWorld->GetTime();
+	mAnimationTime = mWorld->GetTime();
+	if (mAnalyticMotion) mWorld->WrapXY(mPosition.x, mPosition.y);
+	StartSprite();
+}
+
+/** Set the object's sprite. A clocked sprite starts playing from the
+	world's current time. */
+void GameObject::SetSprite(shared_ptr<Sprite> sprite)
+{
+	mSprite = sprite;
+	if (mWorld) StartSprite();
+}
+
+/** Get the frame of its sprite the object shows. A clocked sprite shows
+	the frame for the world's time, offset by the object's phase. */
+int GameObject::GetSpriteFrame() const
+{
+	if (mSprite.get() == NULL) return 0;
+	if (!mSprite->IsClocked() || mWorld == NULL) return mSprite->GetCurrentFrame();
+	return mSprite->GetFrameAt(mWorld->GetTime() + mSpritePhase);
+}
+
+/** Move this object analytically rather than stepping it every update.
+	Only objects that do nothing in Update() but move should use this, as
+	the world no longer calls it. Giving the object an acceleration returns
+	it to being stepped. */
+void GameObject::SetAnalyticMotion(bool analytic)
+{
+	Reanchor();
+	mAnalyticMotion = analytic;
+	CheckAnalyticMotion();
+}
+
+/** Get the object's position at the start of the world's last update. An
+	object that wasn't updated then hasn't moved since. */
+GLVector3f GameObject::GetPreviousPosition()
+{
+	if (mWorld == NULL) return mPreviousPosition;
+	if (mAnalyticMotion) return GetAnalyticPosition(true);
+	return mUpdateTime < mWorld->GetTime() ? mPosition : mPreviousPosition;
+}
+
+/** Update this game object by updating position, velocity and angle of
+	object. Fields that can't change this update are left alone. The world
+	may call this on any thread alongside other objects' updates, so it
+	should only touch this object, and make changes to the world through the
+	world's methods, which queue them until every object has updated. */
 void GameObject::Update(int t)
 {
 	// Calculate seconds since last update
 	float dt = t / 1000.0f;
+	// Remember where the update started for swept collision tests
+	mPreviousPosition = mPosition;
 	// Update angle
-	AddAngle(mRotation * dt);
+	if (mRotation != 0) AddAngle(mRotation * dt);
 	// Update position
 	AddPosition(mVelocity * dt);
 	// Update velocity
-	AddVelocity(mAcceleration * dt);
-	// Update sprite if one exists
-	if (mSprite.get() != NULL) mSprite->Update(t);
+	if (mAcceleration.x != 0 || mAcceleration.y != 0 || mAcceleration.z != 0) AddVelocity(mAcceleration * dt);
 	// If in world, wrap position
 	if (mWorld) { mWorld->WrapXY(mPosition.x, mPosition.y); }
 }
 
+/** Advance this game object's animation. The world may call this alongside
+	other objects' updates, so it should only touch the object's sprite. */
+void GameObject::UpdateAnimation(int t)
+{
+	// Update sprite if one exists
+	if (mSprite.get() != NULL) mSprite->Update(t);
+}
+
 /** Set up rendering system ready to render object. */
 void GameObject::PreRender(void)
 {
 	// Push current transformation matrix onto stack
 	glPushMatrix();
-	// Translate drawing position to ship's position
-	glTranslatef(mPosition.x, mPosition.y, mPosition.z);
-	// Rotate drawing around Z-axis to ship's angle
-	glRotatef(mAngle,0,0,1);
-	// Scale drawing to scale
-	glScalef(mScale, mScale, mScale);
+	// Move, turn and scale drawing to the object's position, angle and scale
+	glMultMatrixf(GetTransform());
 }
 
 /** Render debug graphics if required. */
 void GameObject::Render(void)
 {
 	if (mShape.get() != NULL) mShape->Render();
-	if (mSprite.get() != NULL) mSprite->Render();
+	if (mSprite.get() != NULL) mSprite->RenderFrame(GetSpriteFrame());
 }
 
 /** Clear up after rendering game object. */
@@ -103,4 +247,80 @@ void GameObject::PostRender(void)
 {
 	// Restore projection matrix from stack
 	glPopMatrix();
+}
+
+/** Get the radius around the object's position that it draws within, so
+	it can be skipped when that area is out of view. */
+float GameObject::GetRenderRadius(void)
+{
+	float radius = 0;
+	if (mShape.get() != NULL) radius = mShape->GetRadius();
+	if (mSprite.get() != NULL) {
+		float w = (float)mSprite->GetWidth();
+		float h = (float)mSprite->GetHeight();
+		radius = max(radius, 0.5f * sqrt(w * w + h * h));
+	}
+	return radius * mScale;
+}
+
+// PROTECTED INSTANCE METHODS /////////////////////////////////////////////////
+
+/** Store the current analytic position and angle and anchor them at the
+	world's current time, ready for a change to the object's motion. */
+void GameObject::FoldAnalyticMotion()
+{
+	if (!mWorld) return;
+	mPosition = GetAnalyticPosition(false);
+	mAngle = GetAnalyticAngle();
+	mAnchorTime = mWorld->GetTime();
+}
+
+/** Get the analytic position at the world's current time, or at the start
+	of its last update. Positions are never earlier than the anchor, so an
+	object anchored during the last update didn't move before it. */
+GLVector3f GameObject::GetAnalyticPosition(bool previous)
+{
+	double time = previous ? mWorld->GetPreviousTime() : mWorld->GetTime();
+	double dt = time > mAnchorTime ? time - mAnchorTime : 0;
+	double x = mPosition.x + mVelocity.x * dt;
+	double y = mPosition.y + mVelocity.y * dt;
+	mWorld->WrapXY(x, y);
+	return GLVector3f((GLfloat)x, (GLfloat)y, mPosition.z);
+}
+
+/** Start a clocked sprite playing from the world's current time. When a
+	sprite that doesn't loop will finish, the world calls OnSpriteFinished()
+	rather than the object checking the sprite every update. A sprite
+	shared with other objects keeps its own clock: a looping one plays on
+	at the object's phase, and one that doesn't loop starts for this object
+	by setting its phase instead. */
+void GameObject::StartSprite()
+{
+	if (mSprite.get() == NULL || !mSprite->IsClocked()) return;
+	double now = mWorld->GetTime();
+	if (mSprite.use_count() == 1) {
+		mSprite->SetStartTime(now);
+	} else if (!mSprite->GetLoopAnimation()) {
+		mSpritePhase = mSprite->GetStartTime() - now;
+	}
+	if (mSprite->GetLoopAnimation()) return;
+
+	// Ignore the event if the sprite has been replaced or restarted since
+	double start_time = mSprite->GetStartTime() - mSpritePhase;
+	weak_ptr<GameObject> object = GetThisPtr();
+	weak_ptr<Sprite> sprite = mSprite;
+	mWorld->ScheduleEvent(start_time + mSprite->GetDuration(), [object, sprite, start_time] {
+		shared_ptr<GameObject> o = object.lock();
+		if (o.get() == NULL || o->mSprite != sprite.lock() || o->mSprite->GetStartTime() - o->mSpritePhase != start_time) return;
+		o->OnSpriteFinished();
+	});
+}
+
+/** Get the analytic angle at the world's current time. */
+GLfloat GameObject::GetAnalyticAngle()
+{
+	if (mRotation == 0) return mAngle;
+	double dt = mWorld->GetTime() - mAnchorTime;
+	double angle = fmod(mAngle + mRotation * dt, 360.0);
+	return (GLfloat)(angle < 0 ? angle + 360 : angle);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "GameObjectType.h"
 #include "GameUtil.h"
+#include "GLMatrix.h"
 #include "GameWorld.h"
 #include "Shape.h"
 #include "Sprite.h"
@@ -20,47 +21,81 @@ public:
 	void Reset();
 
 	virtual void Update(int t);
+	virtual void UpdateAnimation(int t);
 	virtual void PreRender(void);
 	virtual void Render(void);
 	virtual void PostRender(void);
+	virtual float GetRenderRadius(void);
 	
 	virtual bool CollisionTest(shared_ptr<GameObject> o) { return false; }
-	virtual void OnCollision(const GameObjectList& objects) {}
+	virtual void OnCollision(const ContactSpan& contacts) {}
+	virtual void OnSpriteFinished() {}
 
 	const GameObjectType& GetType() const { return mType; }
 
-	void SetWorld(GameWorld *w) { mWorld = w; }
+	void SetWorld(GameWorld *w);
 	GameWorld* GetWorld() { return mWorld; }
 
-	void SetAngle(GLfloat a) { mAngle = a; }
-	void SetRotation(GLfloat r) { mRotation = r; }
-	void SetPosition(GLVector3f p) { mPosition = p; }
-	void SetVelocity(GLVector3f v) { mVelocity = v; }
-	void SetAcceleration(GLVector3f a) { mAcceleration = a; }
+	void SetAngle(GLfloat a) { Reanchor(); mAngle = a; }
+	void SetRotation(GLfloat r) { Reanchor(); mRotation = r; }
+	void SetPosition(GLVector3f p) { Reanchor(); mPosition = p; mPreviousPosition = p; }
+	void SetVelocity(GLVector3f v) { Reanchor(); mVelocity = v; }
+	void SetAcceleration(GLVector3f a) { Reanchor(); mAcceleration = a; CheckAnalyticMotion(); }
 	
-	void AddAngle(GLfloat a) { mAngle += a; if (mAngle < 0) mAngle += 360; if (mAngle > 360) mAngle -= 360; }
-	void AddRotation(GLfloat r) { mRotation += r; }
-	void AddPosition(GLVector3f p) { mPosition += p; }
-	void AddVelocity(GLVector3f v) { mVelocity += v; }
-	void AddAcceleration(GLVector3f a) { mAcceleration += a; }
-
-	GLfloat GetAngle() { return mAngle; }
+	void AddAngle(GLfloat a) { Reanchor(); mAngle += a; if (mAngle < 0) mAngle += 360; if (mAngle > 360) mAngle -= 360; }
+	void AddRotation(GLfloat r) { Reanchor(); mRotation += r; }
+	void AddPosition(GLVector3f p) { Reanchor(); mPosition += p; }
+	void AddVelocity(GLVector3f v) { Reanchor(); mVelocity += v; }
+	void AddAcceleration(GLVector3f a) { Reanchor(); mAcceleration += a; CheckAnalyticMotion(); }
+
+	GLfloat GetAngle() { return mAnalyticMotion && mWorld ? GetAnalyticAngle() : mAngle; }
+	const GLVector3f& GetHeading();
+	void SetHeading(GLfloat a, const GLVector3f& heading) { SetAngle(a); mHeadingAngle = a; mHeading = heading; }
+	const GLMatrix4f& GetTransform();
 	GLfloat GetRotation() { return mRotation; }
-	GLVector3f GetPosition() { return mPosition; }
+	GLVector3f GetPosition() { return mAnalyticMotion && mWorld ? GetAnalyticPosition(false) : mPosition; }
 	GLVector3f GetVelocity() { return mVelocity; }
 	GLVector3f GetAcceleration() { return mAcceleration; }
+	GLVector3f GetPreviousPosition();
+
+	void SetAnalyticMotion(bool analytic);
+	bool HasAnalyticMotion() const { return mAnalyticMotion; }
+
+	void SetUpdateTime(double time) { mUpdateTime = time; }
+	double GetUpdateTime() const { return mUpdateTime; }
+	void SetAnimationTime(double time) { mAnimationTime = time; }
+	double GetAnimationTime() const { return mAnimationTime; }
+
+	void SetFastMover(bool fast) { mFastMover = fast; }
+	bool IsFastMover() const { return mFastMover; }
 
 	void SetScale(float s) { mScale = s; }
 	float GetScale() { return mScale; }
 
 	void SetShape(shared_ptr<Shape> shape) { mShape = shape; }
-	void SetSprite(shared_ptr<Sprite> sprite) { mSprite = sprite; }
+	void SetSprite(shared_ptr<Sprite> sprite);
+	const shared_ptr<Sprite>& GetSprite() const { return mSprite; }
+	void SetSpritePhase(double phase) { mSpritePhase = phase; }
+	double GetSpritePhase() const { return mSpritePhase; }
+	int GetSpriteFrame() const;
+	void SetBatchedSprite(bool batched) { mBatchedSprite = batched; }
+	bool IsBatchedSprite() const { return mBatchedSprite && mSprite.get() != NULL; }
 	const shared_ptr<BoundingShape>& GetBoundingShape() const { return mBoundingShape; }
 	void SetBoundingShape(shared_ptr<BoundingShape> bs) { mBoundingShape = bs; }
 
 	shared_ptr<GameObject> GetThisPtr() { return shared_from_this(); }
 
 protected:
+	// The world keeps track of which of its regions each object is in
+	friend class GameWorld;
+
+	void Reanchor() { if (mAnalyticMotion) FoldAnalyticMotion(); }
+	void FoldAnalyticMotion();
+	void CheckAnalyticMotion() { if (mAcceleration.x != 0 || mAcceleration.y != 0 || mAcceleration.z != 0) mAnalyticMotion = false; }
+	GLVector3f GetAnalyticPosition(bool previous);
+	GLfloat GetAnalyticAngle();
+	void StartSprite();
+
 	GameObjectType mType;
 
 	GameWorld* mWorld;
@@ -71,11 +106,54 @@ protected:
 	GLfloat mRotation;
 	GLfloat mScale;
 
+	// Unit vector in the direction the object faces, and the angle it was
+	// worked out for, so it is only worked out again when the angle changes
+	GLVector3f mHeading;
+	GLfloat mHeadingAngle;
+	// Model matrix placing the object in the world, and the position, angle
+	// and scale it was worked out for, so it is only worked out again when
+	// one of them changes
+	GLMatrix4f mTransform;
+	GLVector3f mTransformPosition;
+	GLfloat mTransformAngle;
+	GLfloat mTransformScale;
+
+	// Position at the start of the last update, for swept collision tests
+	GLVector3f mPreviousPosition;
+	// Fast movers are tested for collisions along their whole path over
+	// an update rather than only at its end
+	bool mFastMover;
+
+	// Objects with analytic motion move at a constant velocity and rotation
+	// rate and aren't stepped by the world. Their position and angle are
+	// worked out when asked for, from the world's clock and the position
+	// and angle they had at the anchor time.
+	bool mAnalyticMotion;
+	double mAnchorTime;
+
+	// World time of the object's last update. Objects away from the view
+	// aren't updated every time the world is.
+	double mUpdateTime;
+	// World time the object's animation was last advanced. Only objects
+	// near the view animate, so this falls behind while the object is away.
+	double mAnimationTime;
+	// The world region the object is listed in, and where in its list, or
+	// -1 when the object isn't in a world
+	int mRegion;
+	uint mRegionSlot;
+	// The object's entry in its world's list of objects, so it can be
+	// removed without searching the list
+	GameObjectList::iterator mWorldEntry;
+
 	shared_ptr<Shape> mShape;
 	shared_ptr<Sprite> mSprite;
+	// Seconds the object's clocked sprite runs ahead of the sprite's own
+	// clock, so objects sharing a sprite needn't show the same frame
+	double mSpritePhase;
+	// Objects that only draw their sprite may have the world draw it for
+	// them, batched with every other sprite showing the same frame
+	bool mBatchedSprite;
 	shared_ptr<BoundingShape> mBoundingShape;
-
-	static bool mRenderDebug;
 };
 
 #endif
\ No newline at end of file
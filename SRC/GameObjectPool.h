@@ -0,0 +1,115 @@
+#ifndef __GAMEOBJECTPOOL_H__
+#define __GAMEOBJECTPOOL_H__
+
+#include <functional>
+#include <mutex>
+#include "GameUtil.h"
+#include "GameObject.h"
+#include "BoundingShape.h"
+
+// A pool of game objects of one type, for objects that come and go in
+// large numbers. Objects are made once, with whatever shapes and sprites
+// the pool's factory gives them, and come back to the pool when the last
+// reference to them is dropped rather than being deleted. Each time an
+// object is taken from the pool it is handed out under a new shared_ptr,
+// so weak references to its last use, such as flagged removals, don't
+// find it again. Its bounding shape is pointed at the new shared_ptr.
+// Objects taken from the pool keep whatever state they had, so the
+// caller sets them up again before adding them to a world.
+template <typename T>
+class GameObjectPool
+{
+public:
+	/** Construct a pool that makes new objects with the given factory, or
+		with the default constructor if none is given. */
+	GameObjectPool(const function<T*()>& factory = function<T*()>())
+		: mFactory(factory), mStorage(make_shared<Storage>())
+	{
+	}
+
+	/** Make sure the pool holds at least the given number of free objects,
+		so they can be taken later without being made then. */
+	void Reserve(uint count)
+	{
+		lock_guard<mutex> guard(mStorage->lock);
+		while (mStorage->free.size() < count) mStorage->free.push_back(Create());
+	}
+
+	/** Take an object from the pool, making one if the pool is empty. */
+	shared_ptr<T> Acquire()
+	{
+		T* object = NULL;
+		{
+			lock_guard<mutex> guard(mStorage->lock);
+			if (!mStorage->free.empty()) {
+				object = mStorage->free.back();
+				mStorage->free.pop_back();
+			}
+		}
+		return Wrap(object != NULL ? object : Create());
+	}
+
+	/** Take the given number of objects from the pool, adding them to the
+		end of a list of pointers to T or to one of its base classes. */
+	template <typename U>
+	void Acquire(uint count, vector< shared_ptr<U> >& objects)
+	{
+		objects.reserve(objects.size() + count);
+		lock_guard<mutex> guard(mStorage->lock);
+		for (uint i = 0; i < count; i++) {
+			T* object = NULL;
+			if (!mStorage->free.empty()) {
+				object = mStorage->free.back();
+				mStorage->free.pop_back();
+			}
+			objects.push_back(Wrap(object != NULL ? object : Create()));
+		}
+	}
+
+	/** Get the number of objects waiting in the pool. */
+	uint GetNumFree() const
+	{
+		lock_guard<mutex> guard(mStorage->lock);
+		return (uint)mStorage->free.size();
+	}
+
+private:
+	// The free objects, kept apart from the pool so that objects still in
+	// use when the pool is destroyed can tell, and are deleted instead.
+	// Objects may be released on any thread.
+	struct Storage
+	{
+		~Storage() { for (uint i = 0; i < free.size(); i++) delete free[i]; }
+		mutex lock;
+		vector<T*> free;
+	};
+
+	// Deleter that returns an object to the pool
+	struct Recycler
+	{
+		weak_ptr<Storage> storage;
+		void operator()(T* object) const
+		{
+			shared_ptr<Storage> s = storage.lock();
+			if (s.get() == NULL) { delete object; return; }
+			lock_guard<mutex> guard(s->lock);
+			s->free.push_back(object);
+		}
+	};
+
+	T* Create() { return mFactory ? mFactory() : new T(); }
+
+	shared_ptr<T> Wrap(T* object)
+	{
+		Recycler recycler = { mStorage };
+		shared_ptr<T> ptr(object, recycler);
+		const shared_ptr<BoundingShape>& shape = ptr->GetBoundingShape();
+		if (shape.get() != NULL) shape->SetGameObject(ptr);
+		return ptr;
+	}
+
+	function<T*()> mFactory;
+	shared_ptr<Storage> mStorage;
+};
+
+#endif
@@ -1,20 +1,31 @@
+#include <stdio.h>
 #include "GameUtil.h"
 #include "GameWindow.h"
 #include "GameDisplay.h"
 #include "GameWorld.h"
 #include "GlutSession.h"
 #include "GameSession.h"
+#include "AllocationTracker.h"
+#include "TraceRecorder.h"
+#include "JobScheduler.h"
 
 // PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
 
 /** Construct new game session with given command line arguments. */
 GameSession::GameSession(int argc, char *argv[])
+	: mJobScheduler(NULL),
+	  mJobThreads(0)
 {
 	mGameWorld = new GameWorld();
 	mGameDisplay = new GameDisplay(400, 400);
 	mGameWindow = new GameWindow(400, 400, -1, -1, "GameWindow");
 	mGameWindow->SetDisplay(mGameDisplay);
 	mGameWindow->SetWorld(mGameWorld);
+	ParseArguments(argc, argv);
+	// Share one job scheduler between the window's frame and the world
+	mJobScheduler = new JobScheduler(mJobThreads);
+	mGameWorld->SetJobScheduler(mJobScheduler);
+	mGameWindow->SetJobScheduler(mJobScheduler);
 	// Set the window for this session
 	GlutSession::GetInstance().SetWindow(mGameWindow);
 }
@@ -25,6 +36,7 @@ GameSession::~GameSession()
 	delete mGameWindow;
 	delete mGameDisplay;
 	delete mGameWorld;
+	delete mJobScheduler;
 }
 
 // PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
@@ -46,6 +58,50 @@ void GameSession::Stop(void)
 
 // PROTECTED INSTANCE METHODS /////////////////////////////////////////////////
 
+/** Handle engine command line options.
+	--trace <file>           record a trace and write it to file on exit
+	--trace-seconds <secs>   length of trace history to keep
+	--track-allocations      count heap allocations per frame and scope
+	--stats <file>           write world stats for every update as CSV
+	--threads <n>            threads to run each frame on, 0 for one per core
+	--world-size <w>x<h>     size of the world, which the view scrolls around;
+	                         without it the world resizes with the window */
+void GameSession::ParseArguments(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--trace" && i + 1 < argc) {
+			TraceRecorder::GetInstance().SetThreadName("Main");
+			TraceRecorder::GetInstance().SetEnabled(true);
+			TraceRecorder::GetInstance().WriteOnExit(argv[++i]);
+		}
+		else if (arg == "--trace-seconds" && i + 1 < argc) {
+			TraceRecorder::GetInstance().SetWindowSeconds(atof(argv[++i]));
+		}
+		else if (arg == "--track-allocations") {
+			if (!AllocationTracker::IsAvailable()) cerr << "Allocation tracking needs a build with TRACK_ALLOCATIONS defined" << endl;
+			AllocationTracker::GetInstance().SetEnabled(true);
+		}
+		else if (arg == "--stats" && i + 1 < argc) {
+			mStatsFile.open(argv[++i]);
+			if (mStatsFile.is_open()) mGameWorld->SetStatsStream(&mStatsFile);
+			else cerr << "Error opening " << argv[i] << endl;
+		}
+		else if (arg == "--threads" && i + 1 < argc) {
+			mJobThreads = (uint)atoi(argv[++i]);
+		}
+		else if (arg == "--world-size" && i + 1 < argc) {
+			int w, h;
+			if (sscanf(argv[++i], "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+				mGameWorld->SetWidth(w);
+				mGameWorld->SetHeight(h);
+				mGameWindow->SetResizeWorld(false);
+			}
+			else cerr << "Invalid world size " << argv[i] << endl;
+		}
+	}
+}
+
 /** Protected method to set a timer. */
 void GameSession::SetTimer(uint msecs, int value)
 {
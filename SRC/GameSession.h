@@ -1,11 +1,13 @@
 #ifndef __GAMESESSION_H__
 #define __GAMESESSION_H__
 
+#include <fstream>
 #include "ITimerListener.h"
 
 class GameWorld;
 class GameDisplay;
 class GameWindow;
+class JobScheduler;
 
 class GameSession : public ITimerListener
 {
@@ -22,8 +24,15 @@ protected:
 	GameWorld* mGameWorld;
 	GameDisplay* mGameDisplay;
 	GameWindow* mGameWindow;
+	// Runs the frame's jobs, and any other jobs the game's subsystems add
+	JobScheduler* mJobScheduler;
+	// Threads for the job scheduler, zero for one per core
+	uint mJobThreads;
+
+	std::ofstream mStatsFile;
 
 	void SetTimer(uint msecs, int value);
+	void ParseArguments(int argc, char* argv[]);
 };
 
 #endif
\ No newline at end of file
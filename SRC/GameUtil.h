@@ -4,6 +4,7 @@
 #include <math.h>
 #include <map>
 #include <list>
+#include <vector>
 #include <utility>
 #include <string>
 #include <sstream>
@@ -3,6 +3,8 @@
 #include "IKeyboardListener.h"
 #include "GameDisplay.h"
 #include "GameWindow.h"
+#include "Profiler.h"
+#include "JobScheduler.h"
 
 const int GameWindow::ZOOM_LEVEL = 3;
 
@@ -12,7 +14,9 @@ const int GameWindow::ZOOM_LEVEL = 3;
 GameWindow::GameWindow(int w, int h, int x, int y, char *t)
 	: GlutWindow(w, h, x, y, t),
 	  mWorld(NULL),
-	  mDisplay(NULL)
+	  mDisplay(NULL),
+	  mJobScheduler(NULL),
+	  mResizeWorld(true)
 {
 }
 
@@ -26,18 +30,28 @@ GameWindow::~GameWindow()
 /** Call world and display to render themselves. */
 void GameWindow::OnDisplay(void)
 {
+	PROFILE_SCOPE("GameWindow::OnDisplay");
 	// Clear the backbuffer
 	glClear(GL_COLOR_BUFFER_BIT);
 	// Render the world and display
 	if (mWorld) { mWorld->Render(); }
 	if (mDisplay) { mDisplay->Render(); }
 	// Show the backbuffer
-	glutSwapBuffers();
+	{
+		PROFILE_SCOPE("glutSwapBuffers");
+		glutSwapBuffers();
+	}
 }
 
-/** Update world and display. */
+/** Update world and display. With a job scheduler the frame runs as a
+	graph of jobs: input is passed on first, then the world's update
+	stages, then the display is updated. */
 void GameWindow::OnIdle(void)
 {
+	// Each pass through the idle loop starts a new profiler frame
+	Profiler::GetInstance().NewFrame();
+	AllocationTracker::GetInstance().NewFrame();
+	PROFILE_SCOPE("GameWindow::OnIdle");
 	// Call parent to do any idle loop processing
 	GlutWindow::OnIdle();
 	// Calculate the time in milliseconds since the last update
@@ -45,8 +59,19 @@ void GameWindow::OnIdle(void)
 	int dt=glutGet(GLUT_ELAPSED_TIME)-lasttime;
 	lasttime=glutGet(GLUT_ELAPSED_TIME);
 	// Update the world and display
-	if (mWorld) { mWorld->Update(dt); }
-	if (mDisplay) { mDisplay->Update(dt); }
+	if (mJobScheduler) {
+		JobScheduler::JobHandle input = mJobScheduler->AddJob("GameWindow::DrainInput", [this] { DrainInput(); }, true);
+		JobScheduler::JobHandle world = mWorld ? mWorld->AddUpdateJobs(dt, input) : input;
+		if (mDisplay) {
+			JobScheduler::JobHandle display = mJobScheduler->AddJob("GameDisplay::Update", [this, dt] { mDisplay->Update(dt); }, true);
+			mJobScheduler->AddDependency(display, world);
+		}
+		mJobScheduler->Run();
+	} else {
+		DrainInput();
+		if (mWorld) { mWorld->Update(dt); }
+		if (mDisplay) { mDisplay->Update(dt); }
+	}
 	// Request a redisplay
 	glutPostRedisplay();
 }
@@ -58,23 +83,106 @@ void  GameWindow::OnWindowReshaped(int w, int h)
 	GlutWindow::OnWindowReshaped(w, h);
 	// Reshape the viewport to cover the whole window
 	glViewport(0, 0, w, h);
-	// Update the world and display to match
-	UpdateWorldSize();
+	// Update the world's view and the display to match
+	UpdateViewSize();
 	UpdateDisplaySize();
 }
-   
-void GameWindow::SetWorld(GameWorld* w) { mWorld = w; UpdateWorldSize(); }
+
+/** Queue a key press to pass on at the start of the next frame. */
+void GameWindow::OnKeyPressed(uchar key, int x, int y)
+{
+	InputEvent event = { InputEvent::KEY_PRESSED, key, x, y };
+	mInputEvents.push_back(event);
+}
+
+/** Queue a key release to pass on at the start of the next frame. */
+void GameWindow::OnKeyReleased(uchar key, int x, int y)
+{
+	InputEvent event = { InputEvent::KEY_RELEASED, key, x, y };
+	mInputEvents.push_back(event);
+}
+
+/** Queue a special key press to pass on at the start of the next frame. */
+void GameWindow::OnSpecialKeyPressed(int key, int x, int y)
+{
+	InputEvent event = { InputEvent::SPECIAL_KEY_PRESSED, key, x, y };
+	mInputEvents.push_back(event);
+}
+
+/** Queue a special key release to pass on at the start of the next frame. */
+void GameWindow::OnSpecialKeyReleased(int key, int x, int y)
+{
+	InputEvent event = { InputEvent::SPECIAL_KEY_RELEASED, key, x, y };
+	mInputEvents.push_back(event);
+}
+
+/** Pass every queued keyboard event on to the parent window, and from
+	there to the keyboard listeners, in the order they arrived. */
+void GameWindow::DrainInput(void)
+{
+	for (uint i = 0; i < mInputEvents.size(); i++) {
+		const InputEvent& event = mInputEvents[i];
+		switch (event.type) {
+		case InputEvent::KEY_PRESSED: GlutWindow::OnKeyPressed((uchar)event.key, event.x, event.y); break;
+		case InputEvent::KEY_RELEASED: GlutWindow::OnKeyReleased((uchar)event.key, event.x, event.y); break;
+		case InputEvent::SPECIAL_KEY_PRESSED: HandleSpecialKeyPressed(event.key, event.x, event.y); break;
+		case InputEvent::SPECIAL_KEY_RELEASED: GlutWindow::OnSpecialKeyReleased(event.key, event.x, event.y); break;
+		}
+	}
+	mInputEvents.clear();
+}
+
+/** Handle engine keys, then pass the key on to the parent window. */
+void GameWindow::HandleSpecialKeyPressed(int key, int x, int y)
+{
+	// If the F2 key has been pressed, toggle the profiler overlay
+	if (key == GLUT_KEY_F2 && mDisplay) {
+		mDisplay->SetProfilerOverlayVisible(!mDisplay->IsProfilerOverlayVisible());
+	}
+	// If the F3 key has been pressed, start tracing or dump the trace so far
+	if (key == GLUT_KEY_F3) {
+		DumpTrace();
+	}
+	GlutWindow::OnSpecialKeyPressed(key, x, y);
+}
+
+/** Write the recorded trace to a new file, starting the recorder if needed. */
+void GameWindow::DumpTrace(void)
+{
+	TraceRecorder& recorder = TraceRecorder::GetInstance();
+	if (!TraceRecorder::IsEnabled()) {
+		recorder.SetThreadName("Main");
+		recorder.SetEnabled(true);
+		cout << "Trace recording started, press F3 again to save" << endl;
+		return;
+	}
+	static int trace_count = 0;
+	ostringstream filename;
+	filename << "trace-" << trace_count++ << ".json";
+	if (recorder.Write(filename.str())) {
+		cout << "Saved last " << recorder.GetWindowSeconds() << "s of trace to " << filename.str() << endl;
+	}
+}
+
+void GameWindow::SetWorld(GameWorld* w) { mWorld = w; UpdateViewSize(); }
 GameWorld* GameWindow::GetWorld() { return mWorld; }
 
 void GameWindow::SetDisplay(GameDisplay* d) { mDisplay = d; UpdateDisplaySize(); }
 GameDisplay* GameWindow::GetDisplay() { return mDisplay; }
 
-void GameWindow::UpdateWorldSize()
+void GameWindow::UpdateViewSize()
 {
-	// Set the width and height of the world based on zoom level
+	// Set the width and height of the world's view based on zoom level. The
+	// world is resized to match unless it has a size of its own, which may
+	// be much larger than the view.
 	if (mWorld) {
-		mWorld->SetWidth(glutGet(GLUT_WINDOW_WIDTH)/ZOOM_LEVEL);
-		mWorld->SetHeight(glutGet(GLUT_WINDOW_HEIGHT)/ZOOM_LEVEL);
+		int width = glutGet(GLUT_WINDOW_WIDTH)/ZOOM_LEVEL;
+		int height = glutGet(GLUT_WINDOW_HEIGHT)/ZOOM_LEVEL;
+		mWorld->SetView(mWorld->GetViewCentre(), (float)width, (float)height);
+		if (mResizeWorld) {
+			mWorld->SetWidth(width);
+			mWorld->SetHeight(height);
+		}
 	}
 }
 
@@ -7,6 +7,7 @@
 
 class GameWorld;
 class GameDisplay;
+class JobScheduler;
 
 class GameWindow : public GlutWindow
 {
@@ -17,9 +18,15 @@ public:
 	virtual void OnDisplay(void);
 	virtual void OnIdle(void);
 	virtual void OnWindowReshaped(int w, int h);
+	virtual void OnKeyPressed(uchar key, int x, int y);
+	virtual void OnKeyReleased(uchar key, int x, int y);
+	virtual void OnSpecialKeyPressed(int key, int x, int y);
+	virtual void OnSpecialKeyReleased(int key, int x, int y);
 
-	void UpdateWorldSize(void);
+	void UpdateViewSize(void);
 	void UpdateDisplaySize(void);
+	void DumpTrace(void);
+	void DrainInput(void);
 
 	void SetWorld(GameWorld* w);
 	GameWorld* GetWorld();
@@ -27,11 +34,31 @@ public:
 	void SetDisplay(GameDisplay* w);
 	GameDisplay* GetDisplay();
 
+	void SetJobScheduler(JobScheduler* s) { mJobScheduler = s; }
+	void SetResizeWorld(bool resize) { mResizeWorld = resize; }
+
 protected:
 	static const int ZOOM_LEVEL;
 
+	// A keyboard event waiting to be passed on at the start of the next frame
+	struct InputEvent
+	{
+		enum Type { KEY_PRESSED, KEY_RELEASED, SPECIAL_KEY_PRESSED, SPECIAL_KEY_RELEASED };
+		Type type;
+		int key;
+		int x;
+		int y;
+	};
+
+	void HandleSpecialKeyPressed(int key, int x, int y);
+
 	GameWorld* mWorld;
 	GameDisplay* mDisplay;
+	JobScheduler* mJobScheduler;
+	// Whether the world is resized to match the view, rather than keeping
+	// a size of its own
+	bool mResizeWorld;
+	vector<InputEvent> mInputEvents;
 };
 
 #endif
\ No newline at end of file
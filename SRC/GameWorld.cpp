@@ -1,17 +1,70 @@
+#include <assert.h>
+#include <algorithm>
 #include "GameUtil.h"
 #include "GameObject.h"
 #include "GameWorld.h"
+#include "BoundingShape.h"
+#include "Profiler.h"
+#include "JobScheduler.h"
+
+// Worlds with fewer objects than these update and test collisions on the
+// calling thread
+static const uint PARALLEL_UPDATE_OBJECTS = 1024;
+static const uint PARALLEL_COLLISION_OBJECTS = 512;
+// Number of objects each thread updates at a time
+static const uint UPDATE_CHUNK_OBJECTS = 256;
+// Size of the regions objects are sorted into, and how often objects in
+// mid-range and far regions update. Regions check their objects are still
+// in them as often as mid-range regions update, or far ones when far.
+static const float REGION_SIZE = 256.0f;
+static const uint MID_UPDATE_INTERVAL = 4;
+static const uint FAR_UPDATE_INTERVAL = 64;
+
+// The world whose objects the calling thread is updating, if any, with the
+// thread's command buffer and the update order of the current object
+struct ObjectUpdateContext
+{
+	GameWorld* world;
+	WorldCommandBuffer* commands;
+	uint order;
+};
+static thread_local ObjectUpdateContext sUpdateContext = { NULL, NULL, 0 };
 
 // PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
 
 /** Default constructor. */
-GameWorld::GameWorld(void) : mWidth(200), mHeight(200)
+GameWorld::GameWorld(void)
+	: mJobScheduler(NULL),
+	  mOwnsJobScheduler(false),
+	  mRegionColumns(0),
+	  mRegionRows(0),
+	  mRegionWorldWidth(0),
+	  mRegionWorldHeight(0),
+	  mNearDistance(0),
+	  mFarDistance(0),
+	  mNumAnimatedObjects(0),
+	  mCommandBuffers(1),
+	  mAnimationCommandBuffers(1),
+	  mEventSequence(0),
+	  mCollisionThreads(1),
+	  mCollisionObjects(NULL),
+	  mNumCollisionObjects(0),
+	  mDispatchingCollisions(false),
+	  mViewCentre(0, 0, 0),
+	  mViewWidth(0),
+	  mViewHeight(0),
+	  mWidth(200),
+	  mHeight(200),
+	  mTime(0),
+	  mPreviousTime(0),
+	  mStatsStream(NULL)
 {
 }
 
 /** Destructor. */
 GameWorld::~GameWorld(void)
 {
+	if (mOwnsJobScheduler) delete mJobScheduler;
 }
 
 // PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
@@ -19,56 +72,267 @@ GameWorld::~GameWorld(void)
 /** Update the world. */
 void GameWorld::Update(int t)
 {
-	UpdateObjects(t);
-	UpdateCollisions(t);
+	PROFILE_SCOPE("GameWorld::Update");
 
-	// Remove objects flagged for removal
-	WeakGameObjectList::iterator it = mGameObjectsToRemove.begin();
-	while( it != mGameObjectsToRemove.end() )
-	{
-		RemoveObject(it->lock());
-		it = mGameObjectsToRemove.erase( it );
+	// Run the update as a graph of jobs when there are threads to share it
+	if (mJobScheduler != NULL) {
+		AddUpdateJobs(t, JobScheduler::NO_JOB);
+		mJobScheduler->Run();
+		return;
 	}
 
+	UpdateObjects(t);
+	UpdateCollisions();
+	RemoveFlaggedObjects();
+
 	// Send update message to listeners
 	FireWorldUpdated();
+
+	FinishStats();
+	BuildRenderSnapshot();
+}
+
+/** Add the stages of one update to the world's job scheduler, to start
+	once the given job has finished, and return the last stage. Sprite
+	animation and particles run alongside the object update, and every
+	command and scheduled event is applied before the collision stages, in
+	the same order as UpdateObjects. Objects only change themselves while
+	updating and send any changes to the world through the command buffers,
+	so the update and animation stages may run on any thread. The stages
+	that call listeners and scheduled events, which may not be thread safe,
+	run on the main thread. Stages that may run on any thread spread their
+	work across every thread in large worlds. */
+JobScheduler::JobHandle GameWorld::AddUpdateJobs(int t, JobScheduler::JobHandle after)
+{
+	JobScheduler& scheduler = *mJobScheduler;
+	JobScheduler::JobHandle index = scheduler.AddJob("GameWorld::IndexObjects", [this, t] { AdvanceClock(t); IndexObjects(); }, true);
+	JobScheduler::JobHandle update = scheduler.AddJob("GameWorld::AdvanceObjects", [this] { AdvanceObjects(); });
+	JobScheduler::JobHandle animate = scheduler.AddJob("GameWorld::AdvanceAnimations", [this] { AdvanceAnimations(); });
+	JobScheduler::JobHandle particles = scheduler.AddJob("GameWorld::UpdateParticles", [this, t] { mParticles.Update(t, *this); });
+	JobScheduler::JobHandle apply = scheduler.AddJob("GameWorld::ApplyCommands", [this] {
+		ApplyCommands(mCommandBuffers);
+		ApplyCommands(mAnimationCommandBuffers);
+		FireScheduledEvents();
+	}, true);
+	JobScheduler::JobHandle broad = scheduler.AddJob("GameWorld::BroadPhase", [this] { BuildBroadPhase(); });
+	JobScheduler::JobHandle narrow = scheduler.AddJob("GameWorld::NarrowPhase", [this] { RunNarrowPhase(); });
+	JobScheduler::JobHandle dispatch = scheduler.AddJob("GameWorld::DispatchContacts", [this] { DispatchContacts(); }, true);
+	JobScheduler::JobHandle removal = scheduler.AddJob("GameWorld::RemoveFlaggedObjects", [this] { RemoveFlaggedObjects(); }, true);
+	JobScheduler::JobHandle finish = scheduler.AddJob("GameWorld::FireWorldUpdated", [this] {
+		FireWorldUpdated();
+		FinishStats();
+	}, true);
+	JobScheduler::JobHandle snapshot = scheduler.AddJob("GameWorld::BuildRenderSnapshot", [this] { BuildRenderSnapshot(); });
+
+	scheduler.AddDependency(index, after);
+	scheduler.AddDependency(update, index);
+	scheduler.AddDependency(animate, index);
+	scheduler.AddDependency(particles, index);
+	scheduler.AddDependency(apply, update);
+	scheduler.AddDependency(apply, animate);
+	scheduler.AddDependency(apply, particles);
+	scheduler.AddDependency(broad, apply);
+	scheduler.AddDependency(narrow, broad);
+	scheduler.AddDependency(dispatch, narrow);
+	scheduler.AddDependency(removal, dispatch);
+	scheduler.AddDependency(finish, removal);
+	scheduler.AddDependency(snapshot, finish);
+	return snapshot;
 }
 
 /** Render the world by rendering all of its objects. */
 void GameWorld::Render(void)
 {
+	PROFILE_SCOPE("GameWorld::Render");
+
 	// Update the projection matrix
 	glMatrixMode(GL_PROJECTION);
 	// Store the current projection matrix
 	glPushMatrix();
 	// Initialize the projection matrix to the identity matrix
 	glLoadIdentity();
-	// Set orthographic projection to include the world
-	glOrtho(-mWidth/2, mWidth/2, -mHeight/2, mHeight/2, -100, 100);
+	// Set orthographic projection to include the view
+	float view_width = GetViewWidth();
+	float view_height = GetViewHeight();
+	glOrtho(mViewCentre.x - view_width/2, mViewCentre.x + view_width/2,
+		mViewCentre.y - view_height/2, mViewCentre.y + view_height/2, -100, 100);
 
 	// Switch to model mode ready for rendering
 	glMatrixMode(GL_MODELVIEW);
 	// Initialize the projection matrix to the identity matrix
 	glLoadIdentity();
-	// Render every object in the world
-	for (GameObjectList::iterator it = mGameObjects.begin(); it != mGameObjects.end(); ++it) {
-		(*it)->PreRender();
-		(*it)->Render();
-		(*it)->PostRender();
+	// Draw the batched sprites under everything else
+	mSpriteBatch.Render();
+	// Render every object in the snapshot taken at the end of the update
+	for (uint i = 0; i < mRenderObjects.size(); i++) {
+		const RenderObject& render_object = mRenderObjects[i];
+		bool ghost = render_object.offset.x != 0 || render_object.offset.y != 0;
+		if (ghost) {
+			glPushMatrix();
+			glTranslatef(render_object.offset.x, render_object.offset.y, 0);
+		}
+		render_object.object->PreRender();
+		render_object.object->Render();
+		render_object.object->PostRender();
+		if (ghost) glPopMatrix();
+	}
+
+	// Draw particles over the objects
+	mParticles.Render();
+}
+
+/** Record the objects to draw in the next Render(), in drawing order. Only
+	objects in view are drawn, found through the regions near the view, so
+	objects elsewhere in the world aren't visited. The snapshot holds a
+	reference to each object, so objects removed before the world is drawn
+	are still drawn safely that frame. Objects with batched sprites are laid
+	out in the sprite batch instead, and the particles in view are gathered
+	into batches at the same time. */
+void GameWorld::BuildRenderSnapshot(void)
+{
+	PROFILE_SCOPE("GameWorld::BuildRenderSnapshot");
+
+	// Move the view to follow its target
+	shared_ptr<GameObject> target = mCameraTarget.lock();
+	if (target.get() != NULL) {
+		mViewCentre = target->GetPosition();
+		mViewCentre.z = 0;
+	}
+
+	mRenderObjects.clear();
+	mSpriteBatch.Clear();
+
+	float view_x0 = mViewCentre.x - GetViewWidth()/2;
+	float view_y0 = mViewCentre.y - GetViewHeight()/2;
+	float view_x1 = mViewCentre.x + GetViewWidth()/2;
+	float view_y1 = mViewCentre.y + GetViewHeight()/2;
+
+	// Only objects in regions near the view can be in it. Objects may have
+	// strayed up to a region from the region they are listed in. Region
+	// distances wrap, so regions near the view across an edge are included.
+	float reach_x = GetViewWidth()/2 + mWidth / (float)max(mRegionColumns, 1);
+	float reach_y = GetViewHeight()/2 + mHeight / (float)max(mRegionRows, 1);
+	for (uint region = 0; region < mRegions.size(); region++) {
+		GLVector3f distance = GetRegionDistance(region, mViewCentre);
+		if (distance.x > reach_x || distance.y > reach_y) continue;
+		const vector<const shared_ptr<GameObject>*>& region_objects = mRegions[region].objects;
+		for (uint i = 0; i < region_objects.size(); i++) {
+			// Draw each copy of the object that overlaps the view: the
+			// object itself, and copies one world away for objects that
+			// straddle an edge
+			const shared_ptr<GameObject>& object = *region_objects[i];
+			GLVector3f position = object->GetPosition();
+			float radius = object->GetRenderRadius();
+			for (int oy = -1; oy <= 1; oy++) {
+				float y = position.y + oy * mHeight;
+				if (y + radius < view_y0 || y - radius > view_y1) continue;
+				for (int ox = -1; ox <= 1; ox++) {
+					float x = position.x + ox * mWidth;
+					if (x + radius < view_x0 || x - radius > view_x1) continue;
+					RenderObject render_object = { object, GLVector3f((float)(ox * mWidth), (float)(oy * mHeight), 0) };
+					if (object->IsBatchedSprite()) mSpriteBatch.Add(object.get(), render_object.offset);
+					else mRenderObjects.push_back(render_object);
+				}
+			}
+		}
+	}
+
+	mSpriteBatch.Build();
+	mParticles.BuildRenderBatches(*this);
+}
+
+/** Set how far from the centre of the view, along either axis, objects
+	stay near and mid-range. Passing zero for the near distance uses the
+	size of the view, so objects within half a view of it are near, and
+	zero for the far distance keeps every other object mid-range. */
+void GameWorld::SetSimulationDistances(float near_distance, float far_distance)
+{
+	mNearDistance = near_distance;
+	mFarDistance = far_distance;
+}
+
+/** Get the simulation tier of an object in the world, as of the last
+	update. */
+GameWorld::SimulationTier GameWorld::GetSimulationTier(GameObject* object) const
+{
+	if (object->mRegion < 0) return SIMULATION_NEAR;
+	return mRegions[object->mRegion].tier;
+}
+
+/** Share a job scheduler with the rest of the engine, or pass NULL to run
+	every update on the calling thread. The world doesn't take ownership.
+	Commands and contacts are merged into the same order whatever the
+	number of threads, so results don't depend on it. */
+void GameWorld::SetJobScheduler(JobScheduler* scheduler)
+{
+	if (mOwnsJobScheduler) delete mJobScheduler;
+	mJobScheduler = scheduler;
+	mOwnsJobScheduler = false;
+	uint num_threads = scheduler != NULL ? scheduler->GetNumThreads() : 1;
+	mCommandBuffers.resize(num_threads);
+	mAnimationCommandBuffers.resize(num_threads);
+	mCollisionThreads.resize(num_threads);
+}
+
+/** Give the world a job scheduler of its own with the given number of
+	threads. Passing one, the default, runs on the calling thread only;
+	passing zero uses one thread per hardware core. */
+void GameWorld::SetWorkerThreads(uint num_threads)
+{
+	SetJobScheduler(num_threads != 1 ? new JobScheduler(num_threads) : NULL);
+	mOwnsJobScheduler = mJobScheduler != NULL;
+}
+
+/** Add a listener for the contacts of one type of object. */
+void GameWorld::AddContactListener(const GameObjectType& type, IContactListener* lptr)
+{
+	mContactListeners.push_back(make_pair(type.GetTypeID(), lptr));
+}
+
+/** Remove a contact listener from every type it was added for. */
+void GameWorld::RemoveContactListener(IContactListener* lptr)
+{
+	ContactListenerList::iterator it = mContactListeners.begin();
+	while (it != mContactListeners.end()) {
+		if (it->second == lptr) it = mContactListeners.erase(it);
+		else ++it;
 	}
 }
 
-/** Add a game object to the world. */
+/** Add a game object to the world. Objects added while objects are
+	updating join the world at the end of the update. */
 void GameWorld::AddObject(shared_ptr<GameObject> ptr)
 {
-	// Add game object
-	mGameObjects.push_back(ptr);
-	// Add game object to collision map
-	mCollisions[ptr] = GameObjectList();
-	// Add reference to this world
-	ptr->SetWorld(this);
+	AddObjects(&ptr, 1);
+}
+
+/** Add several objects to the world at once, such as the pieces of
+	something that has broken up. Listeners hear about the objects once
+	they are all in the world. */
+void GameWorld::AddObjects(const shared_ptr<GameObject>* objects, uint count)
+{
+	if (sUpdateContext.world == this) {
+		for (uint i = 0; i < count; i++) sUpdateContext.commands->AddObject(sUpdateContext.order, objects[i]);
+		return;
+	}
+	mStats.objects_added += count;
+	uint run_start = 0;
+	for (uint i = 0; i < count; i++) {
+		const shared_ptr<GameObject>& ptr = objects[i];
+		// Add game object
+		mGameObjects.push_back(ptr);
+		ptr->mWorldEntry = --mGameObjects.end();
+		// Add reference to this world
+		ptr->SetWorld(this);
+		InsertIntoRegion(&mGameObjects.back());
+		// Count each run of objects of the same type at once
+		if (i + 1 == count || objects[i + 1]->GetType() != ptr->GetType()) {
+			CountObjectsAdded(ptr->GetType(), i + 1 - run_start);
+			run_start = i + 1;
+		}
+	}
 	// Send message to all listeners
-	FireObjectAdded(ptr);
+	for (uint i = 0; i < count; i++) FireObjectAdded(objects[i]);
 }
 
 /** Remove a game object from the world. */
@@ -80,37 +344,107 @@ void GameWorld::RemoveObject(GameObject* ptr)
 /** Flags an object for removal so it can be removed after all objects have been updated */
 void GameWorld::FlagForRemoval(weak_ptr<GameObject> ptr)
 {
+	if (sUpdateContext.world == this) {
+		sUpdateContext.commands->FlagForRemoval(sUpdateContext.order, ptr);
+		return;
+	}
 	// Add it to the list of objects to remove
 	mGameObjectsToRemove.push_back(ptr);
 }
 
-/** Remove a game object from the world. */
+/** Remove a game object from the world. Objects that aren't in the world,
+	such as those flagged for removal twice, are ignored. */
 void GameWorld::RemoveObject(shared_ptr<GameObject> ptr)
 {
 	// Check if we the pointer has already been deleted
 	if(ptr.get() == nullptr) return;
+	if (ptr->mWorld != this) return;
+	// Objects being updated or in the collision pass must stay alive until
+	// it has finished
+	if (mDispatchingCollisions || sUpdateContext.world == this) {
+		FlagForRemoval(ptr);
+		return;
+	}
+	mStats.objects_removed++;
+	RemoveFromRegion(ptr.get());
+	CountObjectRemoved(ptr->GetType());
 	// Remove the game object from the list
-	mGameObjects.remove(ptr);
-	// Remove game object from collision map
-	mCollisions.erase(ptr);
+	mGameObjects.erase(ptr->mWorldEntry);
 	// Remove reference to this world
 	ptr->SetWorld(NULL);
 	// Send message to all listeners
 	FireObjectRemoved(ptr);
 }
 
+/** Run a callback once every object has updated. Objects use this for
+	changes to shared state while they update, as objects may update on
+	several threads. Outside an object update the callback runs at once. */
+void GameWorld::PostEvent(const function<void()>& event)
+{
+	if (sUpdateContext.world == this) {
+		sUpdateContext.commands->PostEvent(sUpdateContext.order, event);
+		return;
+	}
+	event();
+}
+
+/** Start a burst of particles from an emitter, leaving a position at an
+	angle in degrees and carried along with a velocity. The burst has the
+	given number of particles, or the emitter's count if that is zero.
+	Bursts started while objects update are held until every object has
+	updated, and start in update order. */
+void GameWorld::EmitParticles(const shared_ptr<ParticleEmitter>& emitter, const GLVector3f& position, const GLVector3f& velocity, float angle, uint count)
+{
+	ParticleBurst burst = { emitter, position, velocity, angle, count > 0 ? count : emitter->count };
+	if (sUpdateContext.world == this) {
+		sUpdateContext.commands->EmitParticles(sUpdateContext.order, burst);
+		return;
+	}
+	mParticles.Emit(burst);
+}
+
+/** Schedule an event to fire once the world's clock reaches the given
+	time, in seconds. Events fire on the main thread after objects and
+	animations have updated, so an event due during an update fires at the
+	end of it. */
+void GameWorld::ScheduleEvent(double time, const function<void()>& event)
+{
+	if (sUpdateContext.world == this) {
+		PostEvent([this, time, event] { ScheduleEvent(time, event); });
+		return;
+	}
+	ScheduledEvent scheduled = { time, mEventSequence++, event };
+	mScheduledEvents.push_back(scheduled);
+	push_heap(mScheduledEvents.begin(), mScheduledEvents.end());
+}
+
 /** Inform all listeners of world update. */
 void GameWorld::FireWorldUpdated()
 {
+	PROFILE_SCOPE("GameWorld::FireWorldUpdated");
+	mStats.listener_callbacks += (uint)mListeners.size();
 	// Send update message to all listeners
 	for (GameWorldListenerList::iterator it = mListeners.begin(); it != mListeners.end(); ++it) {
 		(*it)->OnWorldUpdated(this);
 	}
 }
 
+/** Pass a batch of contacts for one type of object to the contact
+	listeners registered for that type. */
+void GameWorld::FireContacts(const GameObjectType& type, const ContactSpan& contacts)
+{
+	for (ContactListenerList::iterator it = mContactListeners.begin(); it != mContactListeners.end(); ++it) {
+		if (it->first != type.GetTypeID()) continue;
+		mStats.listener_callbacks++;
+		it->second->OnContacts(this, contacts);
+	}
+}
+
 /** Inform all listeners of object addition. */
 void GameWorld::FireObjectAdded(shared_ptr<GameObject> ptr)
 {
+	PROFILE_SCOPE("GameWorld::FireObjectAdded");
+	mStats.listener_callbacks += (uint)mListeners.size();
 	// Send message to all listeners
 	for (GameWorldListenerList::iterator it = mListeners.begin(); it != mListeners.end(); ++it) {
 		(*it)->OnObjectAdded(this, ptr);
@@ -120,91 +454,597 @@ void GameWorld::FireObjectAdded(shared_ptr<GameObject> ptr)
 /** Inform all listeners of object removal. */
 void GameWorld::FireObjectRemoved(shared_ptr<GameObject> ptr)
 {
+	PROFILE_SCOPE("GameWorld::FireObjectRemoved");
+	mStats.listener_callbacks += (uint)mListeners.size();
 	// Send message to all listeners
 	for (GameWorldListenerList::iterator lit = mListeners.begin(); lit != mListeners.end(); ++lit) {
 		(*lit)->OnObjectRemoved(this, ptr);
 	}
 }
 
-/** Get all the collisions for a given object. */
-GameObjectList GameWorld::GetCollisions(shared_ptr<GameObject> ptr)
+/** Update all objects and their animations. Objects added, removed or
+	events posted while objects update are recorded in the updating
+	thread's command buffer and applied once every object has updated, so
+	an object added during the update is first updated in the next one. */
+void GameWorld::UpdateObjects(int t)
 {
-	// Find the named game object
-	CollisionMap::iterator it = mCollisions.find(ptr);
-	// If object does not exist return empty list
-	if (it == mCollisions.end()) {
-		mCollisions[ptr] = GameObjectList();
-		CollisionMap::iterator it2 = mCollisions.find(ptr);
-		return it2->second;
-	}
-	// Otherwise return list from collision map
-	return it->second;
+	PROFILE_SCOPE("GameWorld::UpdateObjects");
+
+	AdvanceClock(t);
+	IndexObjects();
+	AdvanceObjects();
+	AdvanceAnimations();
+	mParticles.Update(t, *this);
+	ApplyCommands(mCommandBuffers);
+	ApplyCommands(mAnimationCommandBuffers);
+	FireScheduledEvents();
 }
 
-/** Get all the collisions for a given object. */
-GameObjectList GameWorld::GetCollisions(GameObject* optr)
+/** Fire every scheduled event that has fallen due. Events may schedule
+	further events. */
+void GameWorld::FireScheduledEvents()
 {
-	return GetCollisions(shared_ptr<GameObject>(optr));
+	while (!mScheduledEvents.empty() && mScheduledEvents.front().time <= mTime) {
+		pop_heap(mScheduledEvents.begin(), mScheduledEvents.end());
+		function<void()> event;
+		event.swap(mScheduledEvents.back().event);
+		mScheduledEvents.pop_back();
+		event();
+	}
 }
 
-/** Update all objects. */
-void GameWorld::UpdateObjects(int t)
+/** Move the world's clock on to the end of this update. Objects with
+	analytic motion are positioned from it. */
+void GameWorld::AdvanceClock(int t)
 {
-	// Update every object in the world
-	GameObjectList::iterator it = mGameObjects.begin();
-	for(GameObjectList::iterator it = mGameObjects.begin(); it != mGameObjects.end(); ++it) 
-	{
-		(*it)->Update(t);
-	}
+	mPreviousTime = mTime;
+	mTime += t / 1000.0;
 }
 
-/** Update all collisions. */
-void GameWorld::UpdateCollisions(int t)
+/** List the objects to update, in update order, so they can be split
+	between threads, with the time each has to catch up on. Near objects
+	update every time. Mid-range and far regions take turns, a few each
+	time, and their objects catch up on the time they missed when they do.
+	Regions also check their objects are still in them when they take
+	their turn, so objects far from the view are rarely visited. */
+void GameWorld::IndexObjects()
 {
-	CollisionMap::iterator it1;
-	CollisionMap::iterator it2;
+	UpdateRegions();
+	uint num_regions = (uint)mRegions.size();
 
-	// Clear collisions
-	for (it1 = mCollisions.begin(); it1 != mCollisions.end(); ++it1) {
-		GameObjectList &collisions = it1->second;
-		collisions.clear();
+	// Move objects that have left the regions taking their turn
+	mMovedObjects.clear();
+	for (uint region = 0; region < num_regions && num_regions > 1; region++) {
+		uint interval = mRegions[region].tier == SIMULATION_FAR ? FAR_UPDATE_INTERVAL : MID_UPDATE_INTERVAL;
+		if ((mStats.frame + region) % interval != 0) continue;
+		vector<const shared_ptr<GameObject>*>& objects = mRegions[region].objects;
+		for (uint i = 0; i < objects.size(); ) {
+			GameObject* object = objects[i]->get();
+			if (GetRegionAt(object->GetPosition()) == region) { i++; continue; }
+			mMovedObjects.push_back(objects[i]);
+			RemoveFromRegion(object);
+		}
 	}
+	for (uint i = 0; i < mMovedObjects.size(); i++) InsertIntoRegion(mMovedObjects[i]);
 
-	// Update collisions
-	for (it1 = mCollisions.begin(); it1 != mCollisions.end(); ++it1) {
-		shared_ptr<GameObject> object1 = it1->first;
-		GameObjectList& collisions1 = it1->second;
-		for (it2 = mCollisions.begin(); it2 != mCollisions.end(); ++it2) {
-			shared_ptr<GameObject> object2 = it2->first;
-			GameObjectList& collisions2 = it2->second;
-			if (object2 != object1) {
-				if (object1->CollisionTest(object2)) {
-					collisions1.push_back(object2);
-					collisions2.push_back(object1);
+	// List near objects first, then the mid-range and far objects whose
+	// turn it is. Away from the view, objects with analytic motion have
+	// nothing to update.
+	mUpdateObjects.clear();
+	mUpdateMillis.clear();
+	mAnimationMillis.clear();
+	for (int tier = SIMULATION_NEAR; tier <= SIMULATION_FAR; tier++) {
+		uint interval = tier == SIMULATION_NEAR ? 1 : tier == SIMULATION_MID ? MID_UPDATE_INTERVAL : FAR_UPDATE_INTERVAL;
+		for (uint region = 0; region < num_regions; region++) {
+			if (mRegions[region].tier != tier || (mStats.frame + region) % interval != 0) continue;
+			const vector<const shared_ptr<GameObject>*>& objects = mRegions[region].objects;
+			for (uint i = 0; i < objects.size(); i++) {
+				GameObject* object = objects[i]->get();
+				if (tier != SIMULATION_NEAR && object->HasAnalyticMotion()) continue;
+				mUpdateObjects.push_back(object);
+				mUpdateMillis.push_back((int)((mTime - object->GetUpdateTime()) * 1000.0 + 0.5));
+				object->SetUpdateTime(mTime);
+				if (tier == SIMULATION_NEAR) {
+					mAnimationMillis.push_back((int)((mTime - object->GetAnimationTime()) * 1000.0 + 0.5));
+					object->SetAnimationTime(mTime);
 				}
 			}
 		}
+		if (tier == SIMULATION_NEAR) mNumAnimatedObjects = (uint)mUpdateObjects.size();
+	}
+
+	mStats.objects = (uint)mGameObjects.size();
+	mStats.objects_by_type = mObjectCounts;
+}
+
+/** Make sure the regions match the world's size, then work out each
+	region's simulation tier from its distance to the centre of the view. */
+void GameWorld::UpdateRegions()
+{
+	if (mRegions.empty() || mRegionWorldWidth != mWidth || mRegionWorldHeight != mHeight) RebuildRegions();
+
+	float near_x = mNearDistance > 0 ? mNearDistance : GetViewWidth();
+	float near_y = mNearDistance > 0 ? mNearDistance : GetViewHeight();
+	for (uint region = 0; region < mRegions.size(); region++) {
+		GLVector3f distance = GetRegionDistance(region, mViewCentre);
+		if (distance.x <= near_x && distance.y <= near_y) mRegions[region].tier = SIMULATION_NEAR;
+		else if (mFarDistance <= 0 || (distance.x <= mFarDistance && distance.y <= mFarDistance)) mRegions[region].tier = SIMULATION_MID;
+		else mRegions[region].tier = SIMULATION_FAR;
+	}
+}
+
+/** Divide the world into regions and sort every object into them. */
+void GameWorld::RebuildRegions()
+{
+	mRegionWorldWidth = mWidth;
+	mRegionWorldHeight = mHeight;
+	mRegionColumns = max((int)ceil(mWidth / REGION_SIZE), 1);
+	mRegionRows = max((int)ceil(mHeight / REGION_SIZE), 1);
+	mRegions.assign(mRegionColumns * mRegionRows, Region());
+	for (uint region = 0; region < mRegions.size(); region++) mRegions[region].tier = SIMULATION_NEAR;
+	for (GameObjectList::iterator it = mGameObjects.begin(); it != mGameObjects.end(); ++it) {
+		(*it)->mRegion = -1;
+		InsertIntoRegion(&(*it));
+	}
+}
+
+/** Get the region containing the given position. */
+uint GameWorld::GetRegionAt(const GLVector3f& position) const
+{
+	int column = (int)floor((position.x + mWidth / 2) * mRegionColumns / mWidth);
+	int row = (int)floor((position.y + mHeight / 2) * mRegionRows / mHeight);
+	column = min(max(column, 0), mRegionColumns - 1);
+	row = min(max(row, 0), mRegionRows - 1);
+	return (uint)(row * mRegionColumns + column);
+}
+
+/** Get the distance along each axis from the given point to the nearest
+	edge of a region, allowing for the world wrapping around, or zero
+	along an axis where the point is inside the region. */
+GLVector3f GameWorld::GetRegionDistance(uint region, const GLVector3f& point) const
+{
+	float region_width = mWidth / (float)mRegionColumns;
+	float region_height = mHeight / (float)mRegionRows;
+	GLVector3f centre(-mWidth / 2 + ((region % mRegionColumns) + 0.5f) * region_width,
+		-mHeight / 2 + ((region / mRegionColumns) + 0.5f) * region_height, 0);
+	GLVector3f offset = GetWrappedOffset(centre, point);
+	return GLVector3f(max(fabs(offset.x) - region_width / 2, 0.0f), max(fabs(offset.y) - region_height / 2, 0.0f), 0);
+}
+
+/** List an object in the region containing it. */
+void GameWorld::InsertIntoRegion(const shared_ptr<GameObject>* object)
+{
+	if (mRegions.empty() || mRegionWorldWidth != mWidth || mRegionWorldHeight != mHeight) {
+		// Rebuilding sorts every object, including this one
+		RebuildRegions();
+		return;
+	}
+	GameObject* ptr = object->get();
+	uint region = GetRegionAt(ptr->GetPosition());
+	ptr->mRegion = (int)region;
+	ptr->mRegionSlot = (uint)mRegions[region].objects.size();
+	mRegions[region].objects.push_back(object);
+}
+
+/** Take an object out of its region's list, moving the last object in the
+	list into its place. */
+void GameWorld::RemoveFromRegion(GameObject* object)
+{
+	if (object->mRegion < 0) return;
+	vector<const shared_ptr<GameObject>*>& objects = mRegions[object->mRegion].objects;
+	uint slot = object->mRegionSlot;
+	objects[slot] = objects.back();
+	(*objects[slot])->mRegionSlot = slot;
+	objects.pop_back();
+	object->mRegion = -1;
+}
+
+/** Update the position and state of every indexed object, in chunks
+	spread across the worker threads in large worlds. */
+void GameWorld::AdvanceObjects()
+{
+	uint num_objects = (uint)mUpdateObjects.size();
+	uint num_chunks = (num_objects + UPDATE_CHUNK_OBJECTS - 1) / UPDATE_CHUNK_OBJECTS;
+	if (mJobScheduler != NULL && num_objects >= PARALLEL_UPDATE_OBJECTS) {
+		mJobScheduler->ParallelForWithThread(num_chunks, [this](uint chunk, uint thread_index) {
+			UpdateChunk(chunk, false, mCommandBuffers[thread_index]);
+		});
+	} else {
+		for (uint chunk = 0; chunk < num_chunks; chunk++) UpdateChunk(chunk, false, mCommandBuffers[0]);
+	}
+}
+
+/** Advance the animation of every near object. Animations only touch
+	their own object's sprite, so they can run alongside the rest of the
+	update, with their own command buffers. */
+void GameWorld::AdvanceAnimations()
+{
+	uint num_objects = mNumAnimatedObjects;
+	uint num_chunks = (num_objects + UPDATE_CHUNK_OBJECTS - 1) / UPDATE_CHUNK_OBJECTS;
+	if (mJobScheduler != NULL && num_objects >= PARALLEL_UPDATE_OBJECTS) {
+		mJobScheduler->ParallelForWithThread(num_chunks, [this](uint chunk, uint thread_index) {
+			UpdateChunk(chunk, true, mAnimationCommandBuffers[thread_index]);
+		});
+	} else {
+		for (uint chunk = 0; chunk < num_chunks; chunk++) UpdateChunk(chunk, true, mAnimationCommandBuffers[0]);
+	}
+}
+
+/** Update or animate one chunk of objects, routing any changes they make
+	to the world into the given command buffer. */
+void GameWorld::UpdateChunk(uint chunk, bool animate, WorldCommandBuffer& commands)
+{
+	ObjectUpdateContext previous = sUpdateContext;
+	sUpdateContext.world = this;
+	sUpdateContext.commands = &commands;
+	uint end = min((chunk + 1) * UPDATE_CHUNK_OBJECTS, animate ? mNumAnimatedObjects : (uint)mUpdateObjects.size());
+	for (uint i = chunk * UPDATE_CHUNK_OBJECTS; i < end; i++) {
+		sUpdateContext.order = i;
+		if (animate) mUpdateObjects[i]->UpdateAnimation(mAnimationMillis[i]);
+		else if (!mUpdateObjects[i]->HasAnalyticMotion()) mUpdateObjects[i]->Update(mUpdateMillis[i]);
+	}
+	sUpdateContext = previous;
+}
+
+/** Apply the commands recorded in the given buffers while objects updated.
+	Every thread's buffer is merged into update order, then the objects are
+	added, the removals flagged and the events run in that order. */
+void GameWorld::ApplyCommands(vector<WorldCommandBuffer>& buffers)
+{
+	PROFILE_SCOPE("GameWorld::ApplyCommands");
+
+	for (uint i = 0; i < buffers.size(); i++) mMergedCommands.Append(buffers[i]);
+	if (mMergedCommands.empty()) return;
+	mMergedCommands.Sort();
+
+	for (uint i = 0; i < mMergedCommands.spawns.size(); i++) {
+		AddObject(mMergedCommands.spawns[i].value);
+	}
+	for (uint i = 0; i < mMergedCommands.removals.size(); i++) {
+		FlagForRemoval(mMergedCommands.removals[i].value);
+	}
+	for (uint i = 0; i < mMergedCommands.bursts.size(); i++) {
+		mParticles.Emit(mMergedCommands.bursts[i].value);
+	}
+	for (uint i = 0; i < mMergedCommands.events.size(); i++) {
+		mMergedCommands.events[i].value();
+	}
+	mMergedCommands.Clear();
+}
+
+/** Update all collisions. The broad phase enters every object with a
+	bounding shape in a grid, and the narrow phase tests each pair of
+	objects that share a cell once, recording the normal, depth and time of
+	impact of each collision. Objects without a bounding shape never
+	collide. Cells are spread across the worker threads in large worlds,
+	each thread writing to its own contact buffer, and the buffers are then
+	merged in object order. The contacts are then laid out in the collision
+	arena sorted by the type of the receiving object, so each type's
+	contacts form one batch and each object's contacts one span, and
+	dispatched batch by batch. The pass makes no heap allocations once
+	warmed up. */
+void GameWorld::UpdateCollisions()
+{
+	PROFILE_SCOPE("GameWorld::UpdateCollisions");
+
+	BuildBroadPhase();
+	RunNarrowPhase();
+	DispatchContacts();
+}
+
+/** Index the objects taking part in the collision pass and enter them in
+	the broad phase grid. */
+void GameWorld::BuildBroadPhase()
+{
+	mCollisionArena.Reset();
+	mCollisionPairs.clear();
+
+	uint num_objects = (uint)mGameObjects.size();
+	const shared_ptr<GameObject>** objects = mCollisionArena.Allocate<const shared_ptr<GameObject>*>(num_objects);
+	uint n = 0;
+	uint num_regions = 0;
+	for (uint region = 0; region < mRegions.size(); region++) {
+		// Far objects don't collide
+		if (mRegions[region].tier == SIMULATION_FAR) continue;
+		num_regions++;
+		const vector<const shared_ptr<GameObject>*>& region_objects = mRegions[region].objects;
+		for (uint i = 0; i < region_objects.size(); i++) {
+			// Objects without a bounding shape can never collide, so leave
+			// them out of the grid altogether
+			if ((*region_objects[i])->GetBoundingShape().get() == NULL) continue;
+			objects[n++] = region_objects[i];
+		}
+	}
+	mCollisionObjects = objects;
+	mNumCollisionObjects = n;
+
+	mCollisionGrid.Build(mCollisionArena, objects, n, *this, num_regions * GetRegionArea());
+}
+
+/** Find colliding pairs, cell by cell. */
+void GameWorld::RunNarrowPhase()
+{
+	uint num_cells = mCollisionGrid.GetNumCells();
+	if (mJobScheduler != NULL && mNumCollisionObjects >= PARALLEL_COLLISION_OBJECTS) {
+		mJobScheduler->ParallelForWithThread(num_cells, [this](uint cell, uint thread_index) {
+			TestCell(cell, thread_index);
+		});
+	} else {
+		for (uint cell = 0; cell < num_cells; cell++) TestCell(cell, 0);
+	}
+	MergeCollisions();
+}
+
+/** Test every pair of objects in a grid cell that doesn't share an earlier
+	cell, so each pair is tested in one cell only. */
+void GameWorld::TestCell(uint cell, uint thread_index)
+{
+	uint size = mCollisionGrid.GetCellSize(cell);
+	const uint* cell_objects = mCollisionGrid.GetCellObjects(cell);
+	for (uint a = 0; a < size; a++) {
+		for (uint b = a + 1; b < size; b++) {
+			uint i = cell_objects[a];
+			uint j = cell_objects[b];
+			if (mCollisionGrid.IsFirstSharedCell(cell, i, j)) TestCollision(i, j, thread_index);
+		}
+	}
+}
+
+/** Test a pair of objects from the collision pass and record a contact for
+	them in the given thread's buffer if they collide. Cells list objects
+	in index order, so i is always less than j. */
+void GameWorld::TestCollision(uint i, uint j, uint thread_index)
+{
+	CollisionThread& thread = mCollisionThreads[thread_index];
+	const shared_ptr<GameObject>& object1 = *mCollisionObjects[i];
+	const shared_ptr<GameObject>& object2 = *mCollisionObjects[j];
+	thread.candidate_pairs++;
+	thread.collision_tests++;
+	bool collision = object1->CollisionTest(object2);
+	if (!collision) {
+		thread.collision_tests++;
+		collision = object2->CollisionTest(object1);
+	}
+	if (!collision) return;
+	thread.collisions++;
+
+	CollisionPair pair;
+	pair.first = i;
+	pair.second = j;
+	pair.contact.object = object1.get();
+	pair.contact.other = object2.get();
+	pair.contact.normal = GLVector3f(0, 0, 0);
+	pair.contact.depth = 0;
+	pair.contact.time_of_impact = 1;
+	const shared_ptr<BoundingShape>& shape1 = object1->GetBoundingShape();
+	const shared_ptr<BoundingShape>& shape2 = object2->GetBoundingShape();
+	if (shape1.get() != NULL && shape2.get() != NULL) shape1->GetContact(shape2, pair.contact);
+	thread.pairs.push_back(pair);
+}
+
+/** Gather the contacts and counters from every collision thread. Which
+	thread tests a pair depends on timing, so the contacts are sorted by
+	object index to give the same order, and so the same dispatch, for any
+	number of threads. */
+void GameWorld::MergeCollisions()
+{
+	for (uint t = 0; t < mCollisionThreads.size(); t++) {
+		CollisionThread& thread = mCollisionThreads[t];
+		mCollisionPairs.insert(mCollisionPairs.end(), thread.pairs.begin(), thread.pairs.end());
+		mStats.candidate_pairs += thread.candidate_pairs;
+		mStats.collision_tests += thread.collision_tests;
+		mStats.collisions += thread.collisions;
+		thread.pairs.clear();
+		thread.candidate_pairs = thread.collision_tests = thread.collisions = 0;
+	}
+	sort(mCollisionPairs.begin(), mCollisionPairs.end(), [](const CollisionPair& a, const CollisionPair& b) {
+		return a.first != b.first ? a.first < b.first : a.second < b.second;
+	});
+}
+
+/** Deliver every contact in the contact buffer to both objects involved.
+	Objects receiving contacts are sorted by type, then by their order in
+	the world, and their contacts copied into the arena in that order. For
+	each type in turn the contact listeners for that type get the whole
+	batch, then each object in the batch gets its own span. */
+void GameWorld::DispatchContacts()
+{
+	if (mCollisionPairs.empty()) return;
+	const shared_ptr<GameObject>** objects = mCollisionObjects;
+	uint num_objects = mNumCollisionObjects;
+
+	// Count each object's contacts and list the objects that have any
+	uint* span_start = mCollisionArena.Allocate<uint>(num_objects);
+	uint* span_end = mCollisionArena.Allocate<uint>(num_objects);
+	for (uint i = 0; i < num_objects; i++) span_end[i] = 0;
+	for (uint k = 0; k < mCollisionPairs.size(); k++) {
+		span_end[mCollisionPairs[k].first]++;
+		span_end[mCollisionPairs[k].second]++;
+	}
+	uint num_receivers = 0;
+	for (uint i = 0; i < num_objects; i++) {
+		if (span_end[i] > 0) num_receivers++;
+	}
+	uint* receivers = mCollisionArena.Allocate<uint>(num_receivers);
+	num_receivers = 0;
+	for (uint i = 0; i < num_objects; i++) {
+		if (span_end[i] > 0) receivers[num_receivers++] = i;
+	}
+	sort(receivers, receivers + num_receivers, [objects](uint a, uint b) {
+		unsigned long type_a = (*objects[a])->GetType().GetTypeID();
+		unsigned long type_b = (*objects[b])->GetType().GetTypeID();
+		return type_a != type_b ? type_a < type_b : a < b;
+	});
+
+	// Lay out the spans in receiver order. Each span's end starts at its
+	// start and advances as contacts are added.
+	uint num_contacts = 0;
+	for (uint r = 0; r < num_receivers; r++) {
+		uint i = receivers[r];
+		uint count = span_end[i];
+		span_start[i] = span_end[i] = num_contacts;
+		num_contacts += count;
+	}
+	Contact* contacts = mCollisionArena.Allocate<Contact>(num_contacts);
+	for (uint k = 0; k < mCollisionPairs.size(); k++) {
+		const CollisionPair& pair = mCollisionPairs[k];
+		contacts[span_end[pair.first]++] = pair.contact;
+		Contact& reverse = contacts[span_end[pair.second]++];
+		reverse.object = pair.contact.other;
+		reverse.other = pair.contact.object;
+		reverse.normal = -pair.contact.normal;
+		reverse.depth = pair.contact.depth;
+		reverse.time_of_impact = pair.contact.time_of_impact;
+	}
+
+	// Call listeners and objects to handle collisions. Objects removed by a
+	// handler are only flagged, so every object in the pass stays alive.
+	mDispatchingCollisions = true;
+	uint batch_start = 0;
+	while (batch_start < num_receivers) {
+		const GameObjectType& type = (*objects[receivers[batch_start]])->GetType();
+		uint batch_end = batch_start + 1;
+		while (batch_end < num_receivers && (*objects[receivers[batch_end]])->GetType() == type) batch_end++;
+
+		uint first_contact = span_start[receivers[batch_start]];
+		uint last_contact = span_end[receivers[batch_end - 1]];
+		FireContacts(type, ContactSpan(contacts + first_contact, last_contact - first_contact));
+
+		for (uint r = batch_start; r < batch_end; r++) {
+			uint i = receivers[r];
+			(*objects[i])->OnCollision(ContactSpan(contacts + span_start[i], span_end[i] - span_start[i]));
+		}
+		batch_start = batch_end;
 	}
+	mDispatchingCollisions = false;
+}
 
+/** Remove all objects that were flagged for removal during the update. */
+void GameWorld::RemoveFlaggedObjects()
+{
+	PROFILE_SCOPE("GameWorld::RemoveFlaggedObjects");
 
-	// Call objects to handle collisions
-	it1 = mCollisions.begin();
-	while (it1 != mCollisions.end()) {
-		// We have to be careful and make a copy of the iterator
-		// before calling OnCollision() in case the object removes itself
-		it2 = it1++;
-		shared_ptr<GameObject> object = it2->first;
-		GameObjectList collisions = it2->second;
-		if (!collisions.empty()) object->OnCollision(collisions);
+	// Index rather than iterate, as listeners may flag more objects. The
+	// list keeps its capacity, so flagging doesn't allocate once warmed up.
+	for (uint i = 0; i < mGameObjectsToRemove.size(); i++)
+	{
+		RemoveObject(mGameObjectsToRemove[i].lock());
 	}
+	mGameObjectsToRemove.clear();
+}
+
+/** Set the area of the world to draw, centred on the given point. Passing
+	a width and height of zero shows the whole world. */
+void GameWorld::SetView(const GLVector3f& centre, float width, float height)
+{
+	mViewCentre = centre;
+	mViewWidth = width;
+	mViewHeight = height;
 }
 
 /** Utility method to wrap positions around the world's edges. */
 void GameWorld::WrapXY(GLfloat &x, GLfloat &y)
+{
+	double dx = x, dy = y;
+	WrapXY(dx, dy);
+	x = (GLfloat)dx;
+	y = (GLfloat)dy;
+}
+
+/** Wrap a position given in double precision, for positions a long way
+	out of bounds. */
+void GameWorld::WrapXY(double &x, double &y)
 {
 	// Wrap x and y coords that are out of the bounds of the world
-	while (x >  mWidth/2)  x -= mWidth; 
-	while (y >  mHeight/2) y -= mHeight; 
-	while (x < -mWidth/2)  x += mWidth; 
-	while (y < -mHeight/2) y += mHeight; 
+	if (x > mWidth/2 || x < -mWidth/2) {
+		x = fmod(x + mWidth/2, (double)mWidth);
+		if (x < 0) x += mWidth;
+		x -= mWidth/2;
+	}
+	if (y > mHeight/2 || y < -mHeight/2) {
+		y = fmod(y + mHeight/2, (double)mHeight);
+		if (y < 0) y += mHeight;
+		y -= mHeight/2;
+	}
+}
+
+/** Get the shortest offset from one point to another, allowing for the
+	world wrapping around at its edges. */
+GLVector3f GameWorld::GetWrappedOffset(const GLVector3f& from, const GLVector3f& to) const
+{
+	GLVector3f offset = to - from;
+	offset.x -= mWidth * floor(offset.x / mWidth + 0.5f);
+	offset.y -= mHeight * floor(offset.y / mHeight + 0.5f);
+	return offset;
+}
+
+/** Write a CSV header and then one row of stats after every update to the
+	given stream. Pass NULL to stop writing. */
+void GameWorld::SetStatsStream(ostream* out)
+{
+	mStatsStream = out;
+	if (mStatsStream) {
+		*mStatsStream << "frame,objects,candidate_pairs,collision_tests,collisions,"
+			"objects_added,objects_removed,listener_callbacks,objects_by_type" << endl;
+	}
+}
+
+/** Get the number of live objects of a type, starting at zero for a type
+	not seen before. Objects are counted against their type as they join
+	and leave the world, so the stats don't need to visit every object. */
+GameObjectTypeCount& GameWorld::GetObjectCount(const GameObjectType& type)
+{
+	vector<GameObjectTypeCount>& counts = mObjectCounts;
+	for (uint i = 0; i < counts.size(); i++) {
+		if (counts[i].type_id == type.GetTypeID()) return counts[i];
+	}
+	GameObjectTypeCount count = { type.GetTypeID(), type.GetTypeName(), 0 };
+	counts.push_back(count);
+	return counts.back();
+}
+
+/** Count objects of a type joining the world. */
+void GameWorld::CountObjectsAdded(const GameObjectType& type, uint num_objects)
+{
+	GetObjectCount(type).count += num_objects;
+}
+
+/** Count an object of a type leaving the world. */
+void GameWorld::CountObjectRemoved(const GameObjectType& type)
+{
+	GameObjectTypeCount& count = GetObjectCount(type);
+	assert(count.count > 0);
+	count.count--;
+}
+
+/** Publish the stats for the update that just finished and start afresh. */
+void GameWorld::FinishStats()
+{
+	const vector<GameObjectTypeCount>& counts = mStats.objects_by_type;
+	mStats.particles = mParticles.GetNumParticles();
+
+	if (TraceRecorder::IsEnabled()) {
+		TraceRecorder::GetInstance().AddCounter("GameObjects", (double)mStats.objects);
+		TraceRecorder::GetInstance().AddCounter("Particles", (double)mStats.particles);
+		for (uint i = 0; i < counts.size(); i++) {
+			TraceRecorder::GetInstance().AddCounter(counts[i].type_name, (double)counts[i].count);
+		}
+	}
+
+	if (mStatsStream) {
+		*mStatsStream << mStats.frame << ',' << mStats.objects << ','
+			<< mStats.candidate_pairs << ',' << mStats.collision_tests << ','
+			<< mStats.collisions << ',' << mStats.objects_added << ','
+			<< mStats.objects_removed << ',' << mStats.listener_callbacks << ',';
+		for (uint i = 0; i < counts.size(); i++) {
+			if (i > 0) *mStatsStream << ';';
+			*mStatsStream << counts[i].type_name << '=' << counts[i].count;
+		}
+		*mStatsStream << '\n';
+	}
+
+	uint frame = mStats.frame;
+	mLastStats = mStats;
+	mStats.Clear();
+	mStats.frame = frame + 1;
 }
@@ -3,26 +3,49 @@
 
 #include "GameUtil.h"
 #include "IGameWorldListener.h"
+#include "IContactListener.h"
+#include "GameObjectType.h"
+#include "GameWorldStats.h"
+#include "Contact.h"
+#include "FrameArena.h"
+#include "CollisionGrid.h"
+#include "ParticleSystem.h"
+#include "SpriteBatch.h"
+#include "WorldCommandBuffer.h"
+#include "JobScheduler.h"
 
 class GameObject;
 
 // Define a type of list to hold game objects
 typedef list< shared_ptr< GameObject > > GameObjectList;
-typedef list< weak_ptr< GameObject > > WeakGameObjectList;
-
-// Define a type of map to hold lists of collisions
-typedef map< shared_ptr<GameObject>, GameObjectList > CollisionMap;
+typedef vector< weak_ptr< GameObject > > WeakGameObjectList;
 
 class GameWorld
 {
 public:
+	// How fully objects are simulated, by their distance from the view.
+	// Near objects update, animate and collide every time the world
+	// updates. Mid-range objects update less often and don't animate. Far
+	// objects don't collide, and objects with analytic motion just move.
+	// Far objects without analytic motion are still updated now and then,
+	// so that objects such as bullets that expire over time still do.
+	enum SimulationTier
+	{
+		SIMULATION_NEAR,
+		SIMULATION_MID,
+		SIMULATION_FAR
+	};
+
 	GameWorld(void);
 	~GameWorld(void);
 
 	void Update(int t);
+	JobScheduler::JobHandle AddUpdateJobs(int t, JobScheduler::JobHandle after);
 	void Render(void);
+	void BuildRenderSnapshot(void);
 
 	void AddObject( shared_ptr<GameObject> ptr );
+	void AddObjects( const shared_ptr<GameObject>* objects, uint count );
 	void RemoveObject( shared_ptr<GameObject> ptr );
 	void RemoveObject( GameObject* ptr );
 	// shared_ptr<GameObject> GetGameObject( string name );
@@ -30,15 +53,24 @@ public:
 	void FlagForRemoval( GameObject* ptr );
 	void FlagForRemoval( weak_ptr<GameObject> ptr );
 
-	GameObjectList GetCollisions( shared_ptr<GameObject> ptr );
-	GameObjectList GetCollisions( GameObject* optr );
+	void PostEvent( const function<void()>& event );
+	void ScheduleEvent( double time, const function<void()>& event );
+
+	void EmitParticles( const shared_ptr<ParticleEmitter>& emitter, const GLVector3f& position, const GLVector3f& velocity, float angle, uint count = 0 );
+	uint GetNumParticles() const { return mParticles.GetNumParticles(); }
+
+	const GameObjectList& GetGameObjects() const { return mGameObjects; }
 
 	void AddListener( IGameWorldListener* lptr) { mListeners.push_back(lptr); }
 	void RemoveListener( IGameWorldListener* lptr) { mListeners.remove(lptr); }
 
+	void AddContactListener( const GameObjectType& type, IContactListener* lptr );
+	void RemoveContactListener( IContactListener* lptr );
+
 	void FireWorldUpdated();
 	void FireObjectAdded( shared_ptr<GameObject> ptr );
 	void FireObjectRemoved( shared_ptr<GameObject> ptr );
+	void FireContacts( const GameObjectType& type, const ContactSpan& contacts );
 
 	void SetWidth(int w) { mWidth = w; }
 	int GetWidth() { return mWidth; }
@@ -47,29 +79,200 @@ public:
 	int GetHeight() { return mHeight; }
 
 	void WrapXY(float &x, float &y);
+	void WrapXY(double &x, double &y);
+	GLVector3f GetWrappedOffset(const GLVector3f& from, const GLVector3f& to) const;
 	float GetWorldWidth() const { return mWidth; }
 	float GetWorldHeight() const { return mHeight; }
+
+	void SetView(const GLVector3f& centre, float width, float height);
+	const GLVector3f& GetViewCentre() const { return mViewCentre; }
+	float GetViewWidth() const { return mViewWidth > 0 ? mViewWidth : mWidth; }
+	float GetViewHeight() const { return mViewHeight > 0 ? mViewHeight : mHeight; }
+	void SetCameraTarget(weak_ptr<GameObject> target) { mCameraTarget = target; }
+
+	void SetSimulationDistances(float near_distance, float far_distance);
+	SimulationTier GetSimulationTier(GameObject* object) const;
+
+	void SetJobScheduler(JobScheduler* scheduler);
+	JobScheduler* GetJobScheduler() const { return mJobScheduler; }
+	void SetWorkerThreads(uint num_threads);
+	uint GetWorkerThreads() const { return (uint)mCommandBuffers.size(); }
+
+	double GetTime() const { return mTime; }
+	double GetPreviousTime() const { return mPreviousTime; }
+
+	const GameWorldStats& GetStats() const { return mLastStats; }
+	void SetStatsStream(ostream* out);
+
 protected:
+	GameObjectTypeCount& GetObjectCount(const GameObjectType& type);
+	void CountObjectsAdded(const GameObjectType& type, uint num_objects);
+	void CountObjectRemoved(const GameObjectType& type);
+	void FinishStats();
+
 	void UpdateObjects(int t);
-	void UpdateCollisions(int t);
+	void AdvanceClock(int t);
+	void IndexObjects();
+	void UpdateRegions();
+	void RebuildRegions();
+	uint GetRegionAt(const GLVector3f& position) const;
+	GLVector3f GetRegionDistance(uint region, const GLVector3f& point) const;
+	float GetRegionArea() const { return mRegions.empty() ? 0 : mWidth * mHeight / mRegions.size(); }
+	void InsertIntoRegion(const shared_ptr<GameObject>* object);
+	void RemoveFromRegion(GameObject* object);
+	void AdvanceObjects();
+	void AdvanceAnimations();
+	void UpdateChunk(uint chunk, bool animate, WorldCommandBuffer& commands);
+	void ApplyCommands(vector<WorldCommandBuffer>& buffers);
+	void FireScheduledEvents();
+	void UpdateCollisions();
+	void BuildBroadPhase();
+	void RunNarrowPhase();
+	void TestCell(uint cell, uint thread_index);
+	void TestCollision(uint i, uint j, uint thread_index);
+	void MergeCollisions();
+	void DispatchContacts();
+	void RemoveFlaggedObjects();
 
 	// Create a map of named game objects
 	GameObjectList mGameObjects;
-	// Create a map of colliding game objects
-	CollisionMap mCollisions;
+
+	// Threads to run the update on, or NULL to run it on the caller
+	JobScheduler* mJobScheduler;
+	bool mOwnsJobScheduler;
+
+	// A square of the world and the objects in it. Objects are moved
+	// between regions as they travel, a few regions at a time, so objects
+	// far from the view aren't visited on most updates.
+	struct Region
+	{
+		vector<const shared_ptr<GameObject>*> objects;
+		SimulationTier tier;
+	};
+	vector<Region> mRegions;
+	int mRegionColumns;
+	int mRegionRows;
+	// The world size the regions were made for
+	int mRegionWorldWidth;
+	int mRegionWorldHeight;
+	// Objects found outside their region, to be moved
+	vector<const shared_ptr<GameObject>*> mMovedObjects;
+	// Distances from the view's centre to the edges of the near and mid
+	// tiers, or zero for the defaults
+	float mNearDistance;
+	float mFarDistance;
+
+	// The objects being updated, in update order, and the milliseconds
+	// each has to catch up on. Near objects come first, and only they
+	// animate, with the milliseconds of animation each has missed.
+	vector<GameObject*> mUpdateObjects;
+	vector<int> mUpdateMillis;
+	vector<int> mAnimationMillis;
+	uint mNumAnimatedObjects;
+	// Live objects of each type, kept as objects are added and removed
+	vector<GameObjectTypeCount> mObjectCounts;
+	// Changes requested by objects during the update and by animations,
+	// one buffer per thread
+	vector<WorldCommandBuffer> mCommandBuffers;
+	vector<WorldCommandBuffer> mAnimationCommandBuffers;
+	// Every thread's commands, merged at the end of the update
+	WorldCommandBuffer mMergedCommands;
+
+	// An event to fire once the world's clock reaches a given time. Events
+	// due at the same time fire in the order they were scheduled.
+	struct ScheduledEvent
+	{
+		double time;
+		uint sequence;
+		function<void()> event;
+		bool operator< (const ScheduledEvent& e) const
+		{
+			return time != e.time ? time > e.time : sequence > e.sequence;
+		}
+	};
+	// Heap of events yet to fire, soonest first
+	vector<ScheduledEvent> mScheduledEvents;
+	uint mEventSequence;
+
+	// Transient collision data, reset at the start of every collision pass
+	FrameArena mCollisionArena;
+	// A collision found by the narrow phase, between the objects at two
+	// indices of the collision pass's object array
+	struct CollisionPair
+	{
+		uint first;
+		uint second;
+		Contact contact;
+	};
+	// Contact buffer and counters written by one thread of the narrow
+	// phase. Each thread's buffer keeps its capacity between passes.
+	struct CollisionThread
+	{
+		CollisionThread() : candidate_pairs(0), collision_tests(0), collisions(0) {}
+		vector<CollisionPair> pairs;
+		uint candidate_pairs;
+		uint collision_tests;
+		uint collisions;
+	};
+	vector<CollisionThread> mCollisionThreads;
+	// The objects and broad phase grid of the collision pass in progress
+	const shared_ptr<GameObject>** mCollisionObjects;
+	uint mNumCollisionObjects;
+	CollisionGrid mCollisionGrid;
+	// Contacts from every thread, merged in object order
+	vector<CollisionPair> mCollisionPairs;
+	// True while OnCollision() is being called, when removals are deferred
+	bool mDispatchingCollisions;
 
 	// Objects to remove when the update has completed
 	WeakGameObjectList mGameObjectsToRemove;
 
+	// The area of the world drawn by Render(). A view with no size shows
+	// the whole world.
+	GLVector3f mViewCentre;
+	float mViewWidth;
+	float mViewHeight;
+	// The object the view follows, if any
+	weak_ptr<GameObject> mCameraTarget;
+
+	// An object to draw and where to draw it, relative to its position.
+	// Objects that straddle an edge of the world are drawn again on the
+	// far side of the world, so they don't pop at the seam.
+	struct RenderObject
+	{
+		shared_ptr<GameObject> object;
+		GLVector3f offset;
+	};
+	// Objects in view, taken at the end of the last update
+	vector<RenderObject> mRenderObjects;
+	// Sprites in view drawn in batches rather than by their objects
+	SpriteBatch mSpriteBatch;
+
+	// Effects that aren't worth a game object each
+	ParticleSystem mParticles;
+
 	// Define a type of list to hold game world listeners
 	typedef list< IGameWorldListener* > GameWorldListenerList;
 	// Create a list of game world listeners
 	GameWorldListenerList mListeners;
+	// Contact listeners and the type ID of the objects they listen to
+	typedef vector< pair<unsigned long, IContactListener*> > ContactListenerList;
+	ContactListenerList mContactListeners;
 
 	// The width of the world
 	int mWidth;
 	// The height of the world
 	int mHeight;
+
+	// Seconds of game time at the end and start of the current update
+	double mTime;
+	double mPreviousTime;
+
+	// Counters for the update in progress and the last completed update
+	GameWorldStats mStats;
+	GameWorldStats mLastStats;
+	// Stream to write a CSV row of stats to after each update
+	ostream* mStatsStream;
 };
 
 #endif
\ No newline at end of file
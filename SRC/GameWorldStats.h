@@ -0,0 +1,59 @@
+#ifndef __GAMEWORLDSTATS_H__
+#define __GAMEWORLDSTATS_H__
+
+#include "GameUtil.h"
+
+// Number of live objects of a single type
+struct GameObjectTypeCount
+{
+	unsigned long type_id;
+	const char* type_name;
+	uint count;
+};
+
+// Counters for a single world update. Objects added or removed between
+// updates (by input handlers or timers) are counted in the next update.
+struct GameWorldStats
+{
+	GameWorldStats() { Clear(); }
+
+	void Clear()
+	{
+		frame = 0;
+		objects = 0;
+		particles = 0;
+		candidate_pairs = 0;
+		collision_tests = 0;
+		collisions = 0;
+		objects_added = 0;
+		objects_removed = 0;
+		listener_callbacks = 0;
+		// Keep the type entries so steady state updates don't allocate
+		for (uint i = 0; i < objects_by_type.size(); i++) objects_by_type[i].count = 0;
+	}
+
+	uint GetObjectCount(const char* type_name) const
+	{
+		for (uint i = 0; i < objects_by_type.size(); i++) {
+			if (strcmp(objects_by_type[i].type_name, type_name) == 0) return objects_by_type[i].count;
+		}
+		return 0;
+	}
+
+	uint frame;
+	uint objects;
+	vector<GameObjectTypeCount> objects_by_type;
+	uint particles;
+	// Pairs of objects considered by the broad phase
+	uint candidate_pairs;
+	// Calls to GameObject::CollisionTest
+	uint collision_tests;
+	// Calls to GameObject::CollisionTest that found a collision
+	uint collisions;
+	uint objects_added;
+	uint objects_removed;
+	// Calls made to IGameWorldListener methods
+	uint listener_callbacks;
+};
+
+#endif
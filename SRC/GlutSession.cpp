@@ -3,6 +3,7 @@
 #include "ITimerListener.h"
 #include "GlutWindow.h"
 #include "GlutSession.h"
+#include "Profiler.h"
 
 GlutWindow* GlutSession::mWindow = NULL;
 bool GlutSession::mIdleFunctionEnabled = false;
@@ -127,6 +128,7 @@ void GlutSession::SetTimer(uint msecs, ITimerListener* listener, int value)
 
 void GlutSession::OnTimer(int key)
 {
+	PROFILE_SCOPE("GlutSession::OnTimer");
 	// Retrieve listener and value given key
 	TimerListenerMap::iterator i = mTimerListeners.find(key);
 	if (i == mTimerListeners.end()) return;
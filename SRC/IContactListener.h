@@ -0,0 +1,14 @@
+#ifndef __ICONTACTLISTENER_H__
+#define __ICONTACTLISTENER_H__
+
+#include "Contact.h"
+
+class GameWorld;
+
+class IContactListener
+{
+public:
+	virtual void OnContacts(GameWorld* world, const ContactSpan& contacts) = 0;
+};
+
+#endif
@@ -133,4 +133,21 @@ void Image::LoadFile(const string& filename)
 	}
 
 	FreeImage_Unload(pBitmap);
-}
\ No newline at end of file
+}
+
+bool Image::SaveFile(const string& filename)
+{
+	FREE_IMAGE_FORMAT format = FreeImage_GetFIFFromFilename(filename.c_str());
+	if (format == FIF_UNKNOWN || !FreeImage_FIFSupportsWriting(format))
+		return false;
+
+	// Pixel data is stored bottom row first as 32 bit BGRA, the same as FreeImage
+	FIBITMAP* pBitmap = FreeImage_ConvertFromRawBits(mPixelData, mWidth, mHeight, 4 * mWidth, 32,
+		FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, FALSE);
+	if (pBitmap == nullptr)
+		return false;
+
+	bool saved = FreeImage_Save(format, pBitmap, filename.c_str()) != FALSE;
+	FreeImage_Unload(pBitmap);
+	return saved;
+}
@@ -15,6 +15,7 @@ public:
 	~Image();
 
 	void SetTransparentColour(uchar r, uchar g, uchar b);
+	bool SaveFile(const string& filename);
 
 	uint GetWidth() const { return mWidth; };
 	uint GetHeight() const { return mHeight; };
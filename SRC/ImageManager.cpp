@@ -1,8 +1,10 @@
 #include "Image.h"
 #include "ImageManager.h"
+#include "Profiler.h"
 
 Image* ImageManager::CreateImageFromFile(const string& name, const uint width, const uint height, const string& filename)
 {
+	PROFILE_SCOPE("ImageManager::CreateImageFromFile");
 	Image* image = new Image(width, height, filename);
 	mImageMap.insert(NamedImageMap::value_type(name, image));
 	return image;
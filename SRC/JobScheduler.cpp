@@ -0,0 +1,337 @@
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include "JobScheduler.h"
+
+using namespace std;
+
+// The scheduler the calling thread works for, if any, and its index there
+static thread_local const JobScheduler* sScheduler = NULL;
+static thread_local uint sThreadIndex = 0;
+
+// Times a waiting thread looks for jobs before going to sleep
+static const uint WAIT_SPIN_COUNT = 64;
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Construct a scheduler with the given number of threads, including the
+	caller. Passing zero uses one thread per hardware core. */
+JobScheduler::JobScheduler(uint num_threads)
+	: mQueuedJobs(0),
+	  mMainQueuedJobs(0),
+	  mStopping(false),
+	  mGraphRemaining(0)
+{
+	if (num_threads == 0) num_threads = thread::hardware_concurrency();
+	if (num_threads == 0) num_threads = 1;
+	mQueues = new WorkQueue[num_threads];
+	// The calling thread always takes part as thread 0, so start one fewer worker
+	for (uint i = 1; i < num_threads; i++) {
+		mThreads.push_back(thread(&JobScheduler::WorkerLoop, this, i));
+	}
+}
+
+/** Destructor. Waits for all workers to finish. */
+JobScheduler::~JobScheduler(void)
+{
+	{
+		unique_lock<mutex> lock(mSleepMutex);
+		mStopping = true;
+	}
+	mWakeCondition.notify_all();
+	for (vector<thread>::iterator it = mThreads.begin(); it != mThreads.end(); ++it) {
+		it->join();
+	}
+	delete[] mQueues;
+	for (uint i = 0; i < mGraph.size(); i++) delete mGraph[i];
+	for (uint i = 0; i < mFreeJobs.size(); i++) delete mFreeJobs[i];
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Get the index of the calling thread within the scheduler. Threads that
+	don't belong to the scheduler count as thread 0. */
+uint JobScheduler::GetThreadIndex() const
+{
+	return sScheduler == this ? sThreadIndex : 0;
+}
+
+/** Add a job to the graph for the next Run(), returning a handle to use
+	for its dependencies. Jobs for the main thread only run on thread 0. */
+JobScheduler::JobHandle JobScheduler::AddJob(const char* name, const function<void()>& fn, bool main_thread)
+{
+	Job* job = AllocateJob();
+	job->name = name;
+	job->fn = fn;
+	job->loop = NULL;
+	job->pending = 1;
+	job->counter = &mGraphRemaining;
+	job->main_thread = main_thread;
+	mGraph.push_back(job);
+	return (JobHandle)(mGraph.size() - 1);
+}
+
+/** Make a job wait for another to finish before it starts. Depending on
+	NO_JOB does nothing. */
+void JobScheduler::AddDependency(JobHandle job, JobHandle dependency)
+{
+	if (dependency == NO_JOB) return;
+	mGraph[dependency]->successors.push_back(mGraph[job]);
+	mGraph[job]->pending++;
+}
+
+/** Run every job added since the last run, in an order that respects their
+	dependencies, and return once they have all finished. The calling
+	thread runs jobs while it waits. */
+void JobScheduler::Run(void)
+{
+	if (mGraph.empty()) return;
+
+	mGraphRemaining = (int)mGraph.size();
+	// Release the hold on every job; those without dependencies start now
+	for (uint i = 0; i < mGraph.size(); i++) {
+		if (--mGraph[i]->pending == 0) Push(mGraph[i]);
+	}
+	Wait(mGraphRemaining);
+
+	for (uint i = 0; i < mGraph.size(); i++) {
+		mGraph[i]->fn = nullptr;
+		FreeJob(mGraph[i]);
+	}
+	mGraph.clear();
+}
+
+/** Call fn(i) for every i in [0, count), spread across all threads.
+	Returns once every call has completed. */
+void JobScheduler::ParallelFor(uint count, const function<void(uint)>& fn)
+{
+	ParallelForWithThread(count, [&fn](uint i, uint) { fn(i); });
+}
+
+/** Call fn(i, thread_index) for every i in [0, count), spread across all
+	threads, where thread_index identifies the thread making the call. A
+	thread runs one call at a time, so fn can write to per-thread state
+	without locking. Returns once every call has completed. */
+void JobScheduler::ParallelForWithThread(uint count, const function<void(uint, uint)>& fn)
+{
+	if (count == 0) return;
+
+	uint thread_index = GetThreadIndex();
+	// Not worth waking the workers for a single item
+	if (mThreads.empty() || count == 1) {
+		for (uint i = 0; i < count; i++) fn(i, thread_index);
+		return;
+	}
+
+	Loop loop;
+	loop.fn = &fn;
+	loop.next = 0;
+	loop.count = count;
+
+	// Queue a share of the loop for other threads to pick up, then take
+	// part on the calling thread
+	uint num_jobs = min(count, GetNumThreads()) - 1;
+	atomic<int> remaining((int)num_jobs);
+	for (uint j = 0; j < num_jobs; j++) {
+		Job* job = AllocateJob();
+		job->name = NULL;
+		job->loop = &loop;
+		job->pending = 0;
+		job->counter = &remaining;
+		job->main_thread = false;
+		Push(job);
+	}
+	RunLoop(loop, thread_index);
+	Wait(remaining);
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Take a job from the pool, creating one if the pool is empty. */
+JobScheduler::Job* JobScheduler::AllocateJob(void)
+{
+	lock_guard<mutex> lock(mFreeMutex);
+	if (mFreeJobs.empty()) return new Job();
+	Job* job = mFreeJobs.back();
+	mFreeJobs.pop_back();
+	return job;
+}
+
+/** Return a finished job to the pool. */
+void JobScheduler::FreeJob(Job* job)
+{
+	lock_guard<mutex> lock(mFreeMutex);
+	mFreeJobs.push_back(job);
+}
+
+/** Queue a job that is ready to run on the calling thread's queue, or on
+	the main thread's queue if it must run there, and wake a thread that
+	can run it. */
+void JobScheduler::Push(Job* job)
+{
+	if (job->main_thread) {
+		{
+			lock_guard<mutex> lock(mMainQueue.mutex);
+			mMainQueue.jobs.push_back(job);
+		}
+		mMainQueuedJobs++;
+		// Only thread 0 can run the job, so wake every sleeper to be sure
+		// of reaching it
+		{
+			lock_guard<mutex> lock(mSleepMutex);
+		}
+		mWakeCondition.notify_all();
+		return;
+	}
+
+	WorkQueue& queue = mQueues[GetThreadIndex()];
+	{
+		lock_guard<mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	mQueuedJobs++;
+	// Take the lock so a worker can't miss the wake up between checking
+	// for jobs and going to sleep
+	{
+		lock_guard<mutex> lock(mSleepMutex);
+	}
+	mWakeCondition.notify_one();
+}
+
+/** Take the newest job from a thread's own queue, or from the main
+	thread's queue first on thread 0. */
+JobScheduler::Job* JobScheduler::Pop(uint thread_index)
+{
+	if (thread_index == 0) {
+		lock_guard<mutex> lock(mMainQueue.mutex);
+		if (mMainQueue.head < mMainQueue.jobs.size()) {
+			Job* job = mMainQueue.jobs[mMainQueue.head++];
+			if (mMainQueue.head == mMainQueue.jobs.size()) {
+				mMainQueue.jobs.clear();
+				mMainQueue.head = 0;
+			}
+			mMainQueuedJobs--;
+			return job;
+		}
+	}
+
+	WorkQueue& queue = mQueues[thread_index];
+	lock_guard<mutex> lock(queue.mutex);
+	if (queue.head == queue.jobs.size()) return NULL;
+	Job* job = queue.jobs.back();
+	queue.jobs.pop_back();
+	if (queue.head == queue.jobs.size()) {
+		queue.jobs.clear();
+		queue.head = 0;
+	}
+	mQueuedJobs--;
+	return job;
+}
+
+/** Take the oldest job from another thread's queue. Returns NULL if every
+	other queue is empty. */
+JobScheduler::Job* JobScheduler::Steal(uint thread_index)
+{
+	uint num_threads = GetNumThreads();
+	for (uint n = 1; n < num_threads; n++) {
+		WorkQueue& queue = mQueues[(thread_index + n) % num_threads];
+		lock_guard<mutex> lock(queue.mutex);
+		if (queue.head == queue.jobs.size()) continue;
+		Job* job = queue.jobs[queue.head++];
+		if (queue.head == queue.jobs.size()) {
+			queue.jobs.clear();
+			queue.head = 0;
+		}
+		mQueuedJobs--;
+		return job;
+	}
+	return NULL;
+}
+
+/** Run one ready job, returning false if there were none. */
+bool JobScheduler::RunOneJob(uint thread_index)
+{
+	Job* job = Pop(thread_index);
+	if (job == NULL) job = Steal(thread_index);
+	if (job == NULL) return false;
+	Execute(job, thread_index);
+	return true;
+}
+
+/** Run a job, then release the jobs that were waiting for it. */
+void JobScheduler::Execute(Job* job, uint thread_index)
+{
+	if (job->loop != NULL) {
+		RunLoop(*job->loop, thread_index);
+	} else {
+		ProfileScope scope(job->name);
+		job->fn();
+	}
+
+	for (uint i = 0; i < job->successors.size(); i++) {
+		if (--job->successors[i]->pending == 0) Push(job->successors[i]);
+	}
+	job->successors.clear();
+
+	// Loop jobs belong to the ParallelFor that made them, which may return
+	// as soon as the counter drops, so finish with the job before that
+	atomic<int>* counter = job->counter;
+	if (job->loop != NULL) FreeJob(job);
+	if (counter->fetch_sub(1) == 1) {
+		// Wake any thread waiting on the counter
+		{
+			lock_guard<mutex> lock(mSleepMutex);
+		}
+		mWakeCondition.notify_all();
+	}
+}
+
+/** Claim and run items from a loop until none are left. */
+void JobScheduler::RunLoop(Loop& loop, uint thread_index)
+{
+	for (uint i = loop.next++; i < loop.count; i = loop.next++) {
+		(*loop.fn)(i, thread_index);
+	}
+}
+
+/** Check whether there are queued jobs the given thread could run. */
+bool JobScheduler::HasWork(uint thread_index) const
+{
+	return mQueuedJobs.load() > 0 || (thread_index == 0 && mMainQueuedJobs.load() > 0);
+}
+
+/** Run jobs on the calling thread until the counter drops to zero. When
+	there is nothing to run, spin briefly in case a job is about to finish,
+	then sleep until a job is queued or the counter drops. */
+void JobScheduler::Wait(atomic<int>& counter)
+{
+	uint thread_index = GetThreadIndex();
+	uint idle = 0;
+	while (counter.load() > 0) {
+		if (RunOneJob(thread_index)) {
+			idle = 0;
+			continue;
+		}
+		if (++idle < WAIT_SPIN_COUNT) {
+			this_thread::yield();
+			continue;
+		}
+		unique_lock<mutex> lock(mSleepMutex);
+		mWakeCondition.wait(lock, [this, &counter, thread_index] { return counter.load() == 0 || HasWork(thread_index); });
+		idle = 0;
+	}
+}
+
+/** Main loop for worker threads. */
+void JobScheduler::WorkerLoop(uint thread_index)
+{
+	sScheduler = this;
+	sThreadIndex = thread_index;
+	TraceRecorder::GetInstance().SetThreadName("JobScheduler worker");
+
+	while (true) {
+		if (RunOneJob(thread_index)) continue;
+		unique_lock<mutex> lock(mSleepMutex);
+		mWakeCondition.wait(lock, [this, thread_index] { return mStopping || HasWork(thread_index); });
+		if (mStopping) return;
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef __JOBSCHEDULER_H__
+#define __JOBSCHEDULER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef unsigned int uint;
+
+// Runs jobs across a fixed set of threads. Jobs added with AddJob() form a
+// graph: each may depend on others, and Run() starts every job as soon as
+// the jobs it depends on have finished, so independent stages of a frame
+// overlap. Each thread keeps its own queue of ready jobs and steals from
+// the others when it runs dry. ParallelFor() spreads a loop across every
+// thread and may be called from inside a job, with the caller running
+// other jobs while it waits.
+//
+// Work may only be added from the thread that created the scheduler or
+// from jobs it is running. That thread is thread 0, and is the only one
+// that runs jobs added for the main thread.
+class JobScheduler
+{
+public:
+	// Identifies a job in the graph being built
+	typedef uint JobHandle;
+	static const JobHandle NO_JOB = 0xffffffff;
+
+	JobScheduler(uint num_threads = 0);
+	~JobScheduler(void);
+
+	uint GetNumThreads() const { return (uint)mThreads.size() + 1; }
+	uint GetThreadIndex() const;
+
+	JobHandle AddJob(const char* name, const std::function<void()>& fn, bool main_thread = false);
+	void AddDependency(JobHandle job, JobHandle dependency);
+	void Run(void);
+
+	void ParallelFor(uint count, const std::function<void(uint)>& fn);
+	void ParallelForWithThread(uint count, const std::function<void(uint, uint)>& fn);
+
+private:
+	JobScheduler(const JobScheduler&);
+	JobScheduler& operator= (const JobScheduler&);
+
+	// A loop being run by ParallelFor. Threads claim items one at a time,
+	// so uneven items balance themselves.
+	struct Loop
+	{
+		const std::function<void(uint, uint)>* fn;
+		std::atomic<uint> next;
+		uint count;
+	};
+
+	// A job in the graph, or one thread's share of a loop. Jobs are pooled
+	// and reused, keeping their successor lists' capacity.
+	struct Job
+	{
+		const char* name;
+		std::function<void()> fn;
+		Loop* loop;
+		// Dependencies still to finish, plus one until the job is released
+		std::atomic<int> pending;
+		std::vector<Job*> successors;
+		// Decremented when the job has finished
+		std::atomic<int>* counter;
+		bool main_thread;
+	};
+
+	// Ready jobs for one thread. The owner takes the newest job and thieves
+	// take the oldest, which is the first of jobs[head, end).
+	struct WorkQueue
+	{
+		WorkQueue() : head(0) {}
+		std::mutex mutex;
+		std::vector<Job*> jobs;
+		uint head;
+	};
+
+	Job* AllocateJob(void);
+	void FreeJob(Job* job);
+	void Push(Job* job);
+	Job* Pop(uint thread_index);
+	Job* Steal(uint thread_index);
+	bool RunOneJob(uint thread_index);
+	void Execute(Job* job, uint thread_index);
+	void RunLoop(Loop& loop, uint thread_index);
+	bool HasWork(uint thread_index) const;
+	void Wait(std::atomic<int>& counter);
+	void WorkerLoop(uint thread_index);
+
+	std::vector<std::thread> mThreads;
+	WorkQueue* mQueues;
+	WorkQueue mMainQueue;
+
+	// Jobs waiting in the thread queues and the main thread's queue, for
+	// waking sleeping threads
+	std::atomic<int> mQueuedJobs;
+	std::atomic<int> mMainQueuedJobs;
+	std::mutex mSleepMutex;
+	std::condition_variable mWakeCondition;
+	bool mStopping;
+
+	// Unused jobs
+	std::mutex mFreeMutex;
+	std::vector<Job*> mFreeJobs;
+
+	// The graph built since the last Run() and its unfinished jobs
+	std::vector<Job*> mGraph;
+	std::atomic<int> mGraphRemaining;
+};
+
+#endif
@@ -0,0 +1,363 @@
+// Benchmark of the SIMD specialisations of the float vector and matrix types.
+//
+// Times each specialised operation over arrays of random vectors and affine
+// matrices, against the same work done by scalar loops written the way the
+// GLVector and GLMatrix templates do it, and reports nanoseconds per
+// operation and the largest difference between the two results. The batch
+// transforms are timed against a loop transforming one point at a time. The
+// fast sine and cosine, one angle at a time and in batches, are timed
+// against the standard library's double precision functions.
+//
+// In builds without SSE2 or NEON, or with GLVECTOR_SIMD undefined, both
+// columns time scalar code.
+//
+// Usage: MathBenchmark [options]
+//   --count <n>              vectors or matrices per pass (default 4096)
+//   --repeats <n>            passes to time each operation over (default 1000)
+//   --seed <n>               random seed (default 1)
+//   --csv                    print results as CSV
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include "GameUtil.h"
+#include "GLMatrix.h"
+#include "FastTrig.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+// Options that control how much work each operation is timed over
+struct BenchmarkOptions
+{
+	BenchmarkOptions()
+		: count(4096), repeats(1000), seed(1), csv(false) {}
+
+	uint count;
+	uint repeats;
+	uint seed;
+	bool csv;
+};
+
+// Inputs and outputs shared by every operation
+struct BenchmarkData
+{
+	vector<GLMatrix4f> matrices;
+	vector<GLVector2f> points2;
+	vector<GLVector3f> points3;
+	vector<GLVector4f> vectors4;
+	vector<float> angles;
+
+	// Results of the scalar and the SIMD version, compared after timing
+	vector<float> scalar_out;
+	vector<float> simd_out;
+};
+
+// SCALAR REFERENCES //////////////////////////////////////////////////////////
+
+// Each works into a local result, as the templates do, so that the compiler
+// needn't allow for the output overlapping the inputs
+
+/** Multiply two column major matrices as the GLMatrix template does. */
+static void ScalarMultiply(const float* a, const float* b, float* r)
+{
+	float ret[16];
+	for (uint j = 0; j < 4; j++) {
+		ret[j] = a[j] * b[0] + a[j + 4] * b[1] + a[j + 8] * b[2] + a[j + 12] * b[3];
+		ret[j + 4] = a[j] * b[4] + a[j + 4] * b[5] + a[j + 8] * b[6] + a[j + 12] * b[7];
+		ret[j + 8] = a[j] * b[8] + a[j + 4] * b[9] + a[j + 8] * b[10] + a[j + 12] * b[11];
+		ret[j + 12] = a[j] * b[12] + a[j + 4] * b[13] + a[j + 8] * b[14] + a[j + 12] * b[15];
+	}
+	memcpy(r, ret, sizeof(ret));
+}
+
+/** Transform a 4D vector as the GLMatrix template does. */
+static void ScalarTransform4(const float* m, const float* v, float* r)
+{
+	float ret[4];
+	for (uint j = 0; j < 4; j++) ret[j] = v[0] * m[j] + v[1] * m[j + 4] + v[2] * m[j + 8] + v[3] * m[j + 12];
+	memcpy(r, ret, sizeof(ret));
+}
+
+/** Transform a point with w = 1 as the GLMatrix template does. */
+static void ScalarTransform3(const float* m, const float* v, float* r)
+{
+	float ret[3] = { 0, 0, 0 };
+	for (uint j = 0; j < 3; j++) {
+		for (uint i = 0; i < 3; i++) ret[j] += v[i] * m[j + i * 4];
+	}
+	for (uint i = 0; i < 3; i++) ret[i] += m[i + 12];
+	float w = m[15];
+	for (uint i = 0; i < 3; i++) w += v[i] * m[3 + i * 4];
+	float resip = 1 / w;
+	for (uint i = 0; i < 3; i++) r[i] = ret[i] * resip;
+}
+
+/** Transform a 2D point with z = 0 and w = 1, ignoring w. */
+static void ScalarTransform2(const float* m, const float* v, float* r)
+{
+	float ret[2];
+	ret[0] = v[0] * m[0] + v[1] * m[4] + m[12];
+	ret[1] = v[0] * m[1] + v[1] * m[5] + m[13];
+	memcpy(r, ret, sizeof(ret));
+}
+
+/** Normalize a vector of the given size as the GLVector templates do. */
+static void ScalarNormalize(const float* v, float* r, uint size)
+{
+	float length_sqr = 0;
+	for (uint i = 0; i < size; i++) length_sqr += v[i] * v[i];
+	float length = sqrt(length_sqr);
+	float ret[4];
+	for (uint i = 0; i < size; i++) ret[i] = v[i] / length;
+	memcpy(r, ret, size * sizeof(float));
+}
+
+// OPERATIONS /////////////////////////////////////////////////////////////////
+
+// Each operation runs once over all the data, writing its results to out
+typedef void (*Operation)(const BenchmarkData& data, float* out);
+
+static void ScalarMatrixMultiply(const BenchmarkData& data, float* out)
+{
+	uint n = (uint)data.matrices.size();
+	for (uint i = 0; i < n; i++) ScalarMultiply(data.matrices[i], data.matrices[(i + 1) % n], out + i * 16);
+}
+
+static void SimdMatrixMultiply(const BenchmarkData& data, float* out)
+{
+	uint n = (uint)data.matrices.size();
+	for (uint i = 0; i < n; i++) {
+		GLMatrix4f r = data.matrices[i] * data.matrices[(i + 1) % n];
+		memcpy(out + i * 16, (const float*)r, 16 * sizeof(float));
+	}
+}
+
+static void ScalarMatrixVector4(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.vectors4.size(); i++) ScalarTransform4(data.matrices[i], data.vectors4[i], out + i * 4);
+}
+
+static void SimdMatrixVector4(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.vectors4.size(); i++) {
+		GLVector4f r = data.matrices[i] * data.vectors4[i];
+		r.copyTo(out + i * 4);
+	}
+}
+
+static void ScalarMatrixVector3(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.points3.size(); i++) ScalarTransform3(data.matrices[i], data.points3[i], out + i * 3);
+}
+
+static void SimdMatrixVector3(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.points3.size(); i++) {
+		GLVector3f r = data.matrices[i] * data.points3[i];
+		r.copyTo(out + i * 3);
+	}
+}
+
+static void ScalarNormalize4(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.vectors4.size(); i++) ScalarNormalize(data.vectors4[i], out + i * 4, 4);
+}
+
+static void SimdNormalize4(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.vectors4.size(); i++) {
+		GLVector4f r = data.vectors4[i].unit();
+		r.copyTo(out + i * 4);
+	}
+}
+
+static void ScalarTransformPoints2(const BenchmarkData& data, float* out)
+{
+	const float* m = data.matrices[0];
+	for (uint i = 0; i < data.points2.size(); i++) ScalarTransform2(m, data.points2[i], out + i * 2);
+}
+
+static void SimdTransformPoints2(const BenchmarkData& data, float* out)
+{
+	data.matrices[0].transformPoints(&data.points2[0], (GLVector2f*)out, (uint)data.points2.size());
+}
+
+static void ScalarTransformPoints3(const BenchmarkData& data, float* out)
+{
+	const float* m = data.matrices[0];
+	for (uint i = 0; i < data.points3.size(); i++) ScalarTransform3(m, data.points3[i], out + i * 3);
+}
+
+static void SimdTransformPoints3(const BenchmarkData& data, float* out)
+{
+	data.matrices[0].transformPoints(&data.points3[0], (GLVector3f*)out, (uint)data.points3.size());
+}
+
+static void ScalarTransformVectors4(const BenchmarkData& data, float* out)
+{
+	const float* m = data.matrices[0];
+	for (uint i = 0; i < data.vectors4.size(); i++) ScalarTransform4(m, data.vectors4[i], out + i * 4);
+}
+
+static void SimdTransformVectors4(const BenchmarkData& data, float* out)
+{
+	data.matrices[0].transformVectors(&data.vectors4[0], (GLVector4f*)out, (uint)data.vectors4.size());
+}
+
+static void ScalarSinCos(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.angles.size(); i++) {
+		out[i * 2] = (float)sin(DEG2RAD * data.angles[i]);
+		out[i * 2 + 1] = (float)cos(DEG2RAD * data.angles[i]);
+	}
+}
+
+static void FastSinCos(const BenchmarkData& data, float* out)
+{
+	for (uint i = 0; i < data.angles.size(); i++) SinCosDegrees(data.angles[i], out[i * 2], out[i * 2 + 1]);
+}
+
+static void FastSinCosBatch(const BenchmarkData& data, float* out)
+{
+	// The batch writes sines and cosines to separate arrays; interleave them
+	// afterwards so the results line up with the scalar ones
+	uint n = (uint)data.angles.size();
+	float* s = out + n * 2;
+	float* c = out + n * 3;
+	SinCosDegrees(&data.angles[0], s, c, n);
+	for (uint i = 0; i < n; i++) {
+		out[i * 2] = s[i];
+		out[i * 2 + 1] = c[i];
+	}
+}
+
+// An operation timed both ways, with the number of floats each result has
+struct BenchmarkCase
+{
+	const char* name;
+	Operation scalar;
+	Operation simd;
+	uint result_floats;
+};
+
+static const BenchmarkCase CASES[] = {
+	{ "matrix * matrix", ScalarMatrixMultiply, SimdMatrixMultiply, 16 },
+	{ "matrix * vector4", ScalarMatrixVector4, SimdMatrixVector4, 4 },
+	{ "matrix * vector3", ScalarMatrixVector3, SimdMatrixVector3, 3 },
+	{ "vector4 unit", ScalarNormalize4, SimdNormalize4, 4 },
+	{ "transform points 2D", ScalarTransformPoints2, SimdTransformPoints2, 2 },
+	{ "transform points 3D", ScalarTransformPoints3, SimdTransformPoints3, 3 },
+	{ "transform vectors 4D", ScalarTransformVectors4, SimdTransformVectors4, 4 },
+	{ "sincos", ScalarSinCos, FastSinCos, 2 },
+	{ "sincos batch", ScalarSinCos, FastSinCosBatch, 2 },
+};
+
+/** Fill the inputs with random affine matrices and vectors. */
+static void PopulateData(BenchmarkData& data, const BenchmarkOptions& options)
+{
+	mt19937 random(options.seed);
+	uniform_real_distribution<float> coord(-500, 500);
+	uniform_real_distribution<float> angle(0, 360);
+	uniform_real_distribution<float> scale(0.25f, 4);
+	for (uint i = 0; i < options.count; i++) {
+		GLMatrix4f m;
+		m.loadTranslate(coord(random), coord(random), 0);
+		m.applyRotateZ(angle(random));
+		float s = scale(random);
+		m.applyScale(s, s, s);
+		data.matrices.push_back(m);
+		data.points2.push_back(GLVector2f(coord(random), coord(random)));
+		data.points3.push_back(GLVector3f(coord(random), coord(random), coord(random)));
+		data.vectors4.push_back(GLVector4f(coord(random), coord(random), coord(random), 1));
+		data.angles.push_back(angle(random));
+	}
+	data.scalar_out.resize(options.count * 16);
+	data.simd_out.resize(options.count * 16);
+}
+
+/** Time an operation over the given number of passes, in nanoseconds per
+	operation. */
+static double TimeOperation(Operation operation, const BenchmarkData& data, float* out, uint repeats)
+{
+	operation(data, out);
+	Clock::time_point start = Clock::now();
+	for (uint i = 0; i < repeats; i++) operation(data, out);
+	double elapsed = chrono::duration<double, nano>(Clock::now() - start).count();
+	return elapsed / ((double)repeats * data.matrices.size());
+}
+
+/** Get the largest difference between the scalar and SIMD results, relative
+	to the size of the scalar result. */
+static double MaxDifference(const BenchmarkData& data, uint num_floats)
+{
+	double max_difference = 0;
+	for (uint i = 0; i < num_floats; i++) {
+		double a = data.scalar_out[i];
+		double b = data.simd_out[i];
+		double difference = fabs(a - b) / max(1.0, fabs(a));
+		max_difference = max(max_difference, difference);
+	}
+	return max_difference;
+}
+
+/** Parse command line options, returning false on an unknown option. */
+static bool ParseOptions(int argc, char* argv[], BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--count" && has_value) {
+			options.count = (uint)atoi(argv[++i]);
+		} else if (arg == "--repeats" && has_value) {
+			options.repeats = (uint)atoi(argv[++i]);
+		} else if (arg == "--seed" && has_value) {
+			options.seed = (uint)atoi(argv[++i]);
+		} else if (arg == "--csv") {
+			options.csv = true;
+		} else {
+			return false;
+		}
+	}
+	return options.count > 0;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		cerr << "Usage: MathBenchmark [--count n] [--repeats n] [--seed n] [--csv]" << endl;
+		return 1;
+	}
+
+	BenchmarkData data;
+	PopulateData(data, options);
+
+#if defined(GLVECTOR_USE_SSE)
+	const char* simd = "SSE2";
+#elif defined(GLVECTOR_USE_NEON)
+	const char* simd = "NEON";
+#else
+	const char* simd = "none";
+#endif
+	if (options.csv) {
+		printf("operation,count,scalar_ns,simd_ns,speedup,max_difference\n");
+	} else {
+		printf("%u operations a pass, %u passes; SIMD: %s\n", options.count, options.repeats, simd);
+		printf("%-22s %12s %12s %9s %16s\n", "operation", "scalar ns", "simd ns", "speedup", "max difference");
+	}
+
+	for (uint i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+		const BenchmarkCase& c = CASES[i];
+		double scalar = TimeOperation(c.scalar, data, &data.scalar_out[0], options.repeats);
+		double simd = TimeOperation(c.simd, data, &data.simd_out[0], options.repeats);
+		double difference = MaxDifference(data, options.count * c.result_floats);
+		if (options.csv) {
+			printf("%s,%u,%.3f,%.3f,%.2f,%g\n", c.name, options.count, scalar, simd, scalar / simd, difference);
+		} else {
+			printf("%-22s %12.3f %12.3f %8.2fx %16g\n", c.name, scalar, simd, scalar / simd, difference);
+		}
+		fflush(stdout);
+	}
+	return 0;
+}
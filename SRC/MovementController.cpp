@@ -18,9 +18,7 @@ MovementController::~MovementController()
 
 void MovementController::Accelerate(GLfloat a)
 {
-	float angle = mObject->GetAngle();
-	GLVector3f heading(cos(DEG2RAD*angle), sin(DEG2RAD*angle), 0);
-	mObject->SetAcceleration(heading * a);
+	mObject->SetAcceleration(mObject->GetHeading() * a);
 	mAcceleration = a;
 }
 
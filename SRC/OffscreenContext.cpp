@@ -0,0 +1,125 @@
+#include "GameUtil.h"
+#include "Image.h"
+#include "OffscreenContext.h"
+
+#ifdef USE_OSMESA
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+#ifdef USE_OSMESA
+
+/** Create an OSMesa context rendering into a buffer of the given size and
+	make it current. Check IsValid() before rendering. */
+OffscreenContext::OffscreenContext(uint width, uint height)
+	: mWidth(width), mHeight(height), mValid(false), mContext(NULL), mDisplay(NULL), mSurface(NULL)
+{
+	OSMesaContext context = OSMesaCreateContextExt(OSMESA_BGRA, 16, 0, 0, NULL);
+	if (!context) {
+		cerr << "Error creating OSMesa context" << endl;
+		return;
+	}
+	mContext = context;
+	mBuffer.resize(4 * width * height);
+	if (!OSMesaMakeCurrent(context, &mBuffer[0], GL_UNSIGNED_BYTE, width, height)) {
+		cerr << "Error making OSMesa context current" << endl;
+		return;
+	}
+	mValid = true;
+}
+
+/** Destructor. */
+OffscreenContext::~OffscreenContext(void)
+{
+	if (mContext) OSMesaDestroyContext((OSMesaContext)mContext);
+}
+
+#else
+
+/** Create an EGL pbuffer context of the given size and make it current.
+	Check IsValid() before rendering. */
+OffscreenContext::OffscreenContext(uint width, uint height)
+	: mWidth(width), mHeight(height), mValid(false), mContext(NULL), mDisplay(NULL), mSurface(NULL)
+{
+	// Prefer Mesa's surfaceless platform, which needs no display server
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (get_platform_display) {
+		display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+		cerr << "Error initialising EGL" << endl;
+		return;
+	}
+	mDisplay = display;
+
+	const EGLint config_attribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint num_configs = 0;
+	if (!eglChooseConfig(display, config_attribs, &config, 1, &num_configs) || num_configs == 0) {
+		cerr << "Error choosing EGL config" << endl;
+		return;
+	}
+
+	const EGLint surface_attribs[] = { EGL_WIDTH, (EGLint)width, EGL_HEIGHT, (EGLint)height, EGL_NONE };
+	EGLSurface surface = eglCreatePbufferSurface(display, config, surface_attribs);
+	if (surface == EGL_NO_SURFACE) {
+		cerr << "Error creating EGL pbuffer" << endl;
+		return;
+	}
+	mSurface = surface;
+
+	// The renderer uses fixed function OpenGL, so ask for desktop GL
+	eglBindAPI(EGL_OPENGL_API);
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+	if (context == EGL_NO_CONTEXT) {
+		cerr << "Error creating EGL context" << endl;
+		return;
+	}
+	mContext = context;
+	if (!eglMakeCurrent(display, surface, surface, context)) {
+		cerr << "Error making EGL context current" << endl;
+		return;
+	}
+	mValid = true;
+}
+
+/** Destructor. */
+OffscreenContext::~OffscreenContext(void)
+{
+	if (!mDisplay) return;
+	eglMakeCurrent((EGLDisplay)mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (mContext) eglDestroyContext((EGLDisplay)mDisplay, (EGLContext)mContext);
+	if (mSurface) eglDestroySurface((EGLDisplay)mDisplay, (EGLSurface)mSurface);
+	eglTerminate((EGLDisplay)mDisplay);
+}
+
+#endif
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Wait for all rendering to complete. */
+void OffscreenContext::Finish(void)
+{
+	glFinish();
+}
+
+/** Save the current contents of the frame buffer to an image file. */
+bool OffscreenContext::SaveFrame(const string& filename)
+{
+	Image frame(mWidth, mHeight);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, mWidth, mHeight, GL_BGRA_EXT, GL_UNSIGNED_BYTE, frame.GetPixelData());
+	return frame.SaveFile(filename);
+}
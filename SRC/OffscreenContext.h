@@ -0,0 +1,38 @@
+#ifndef __OFFSCREENCONTEXT_H__
+#define __OFFSCREENCONTEXT_H__
+
+#include "GameUtil.h"
+
+// An OpenGL context that renders into memory rather than a window, for
+// running render code on machines without a GPU or display. Built on
+// OSMesa when USE_OSMESA is defined, otherwise on EGL pbuffers, which
+// Mesa's software drivers provide on the surfaceless platform.
+class OffscreenContext
+{
+public:
+	OffscreenContext(uint width, uint height);
+	~OffscreenContext(void);
+
+	bool IsValid() const { return mValid; }
+	uint GetWidth() const { return mWidth; }
+	uint GetHeight() const { return mHeight; }
+
+	void Finish(void);
+	bool SaveFrame(const string& filename);
+
+private:
+	OffscreenContext(const OffscreenContext&);
+	OffscreenContext& operator= (const OffscreenContext&);
+
+	uint mWidth;
+	uint mHeight;
+	bool mValid;
+
+	// Backend specific handles
+	void* mContext;
+	void* mDisplay;
+	void* mSurface;
+	vector<uchar> mBuffer;
+};
+
+#endif
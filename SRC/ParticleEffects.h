@@ -0,0 +1,62 @@
+#ifndef __PARTICLEEFFECTS_H__
+#define __PARTICLEEFFECTS_H__
+
+#include "GameUtil.h"
+#include "ParticleSystem.h"
+
+// The particle emitters used by the game, shared with the benchmarks so
+// they draw the same effects.
+
+/** Create the emitter for the flash of sparks when something explodes. */
+inline shared_ptr<ParticleEmitter> CreateExplosionEmitter()
+{
+	shared_ptr<ParticleEmitter> emitter = make_shared<ParticleEmitter>();
+	emitter->count = 60;
+	emitter->min_speed = 5;
+	emitter->max_speed = 40;
+	emitter->min_life = 0.3f;
+	emitter->max_life = 0.9f;
+	emitter->drag = 1.5f;
+	emitter->size = 3;
+	emitter->start_colour = GLVector3f(1.0f, 0.9f, 0.5f);
+	emitter->end_colour = GLVector3f(0.8f, 0.2f, 0.0f);
+	return emitter;
+}
+
+/** Create the emitter for the rock left drifting after an asteroid breaks. */
+inline shared_ptr<ParticleEmitter> CreateDebrisEmitter()
+{
+	shared_ptr<ParticleEmitter> emitter = make_shared<ParticleEmitter>();
+	emitter->count = 12;
+	emitter->min_speed = 2;
+	emitter->max_speed = 12;
+	emitter->min_life = 1.0f;
+	emitter->max_life = 2.0f;
+	emitter->drag = 0.3f;
+	emitter->size = 2;
+	emitter->start_colour = GLVector3f(0.7f, 0.65f, 0.6f);
+	emitter->end_colour = GLVector3f(0.3f, 0.3f, 0.3f);
+	emitter->max_particles = 1024;
+	return emitter;
+}
+
+/** Create the emitter for the spaceship's exhaust, which it emits steadily
+	from behind itself while it thrusts. */
+inline shared_ptr<ParticleEmitter> CreateThrusterEmitter()
+{
+	shared_ptr<ParticleEmitter> emitter = make_shared<ParticleEmitter>();
+	emitter->rate = 120;
+	emitter->min_speed = 8;
+	emitter->max_speed = 15;
+	emitter->spread = 15;
+	emitter->min_life = 0.2f;
+	emitter->max_life = 0.4f;
+	emitter->drag = 2.0f;
+	emitter->size = 2;
+	emitter->start_colour = GLVector3f(1.0f, 0.8f, 0.3f);
+	emitter->end_colour = GLVector3f(1.0f, 0.1f, 0.0f);
+	emitter->max_particles = 256;
+	return emitter;
+}
+
+#endif
@@ -0,0 +1,257 @@
+#include "GameUtil.h"
+#include "GameWorld.h"
+#include "Profiler.h"
+#include "ParticleSystem.h"
+
+// SSE2 is always there on x64, and on x86 when the compiler is told to use it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// Floats per particle vertex: x, y and an RGBA colour
+static const uint VERTEX_FLOATS = 6;
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Default constructor. */
+ParticleSystem::ParticleSystem()
+	: mRandom(1)
+{
+}
+
+/** Destructor. */
+ParticleSystem::~ParticleSystem()
+{
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Start a burst of particles. Storage for an emitter's particles is made
+	when it is first used, so bursts don't allocate after that. */
+void ParticleSystem::Emit(const ParticleBurst& burst)
+{
+	const ParticleEmitter& emitter = *burst.emitter;
+	Pool& pool = GetPool(burst.emitter);
+	uint room = emitter.max_particles - min((uint)pool.x.size(), emitter.max_particles);
+	uint count = min(burst.count, room);
+	for (uint i = 0; i < count; i++) {
+		float angle = (float)(DEG2RAD * (burst.angle + Random(-emitter.spread, emitter.spread)));
+		float speed = Random(emitter.min_speed, emitter.max_speed);
+		pool.x.push_back(burst.position.x);
+		pool.y.push_back(burst.position.y);
+		pool.vx.push_back(burst.velocity.x + speed * cos(angle));
+		pool.vy.push_back(burst.velocity.y + speed * sin(angle));
+		pool.age.push_back(0);
+		pool.life.push_back(Random(emitter.min_life, emitter.max_life));
+	}
+}
+
+/** Move and age every particle, wrapping them at the world's edges, then
+	drop those that have died, and the pools of emitters no longer used. */
+void ParticleSystem::Update(int t, const GameWorld& world)
+{
+	PROFILE_SCOPE("ParticleSystem::Update");
+
+	float dt = t / 1000.0f;
+	float width = world.GetWorldWidth();
+	float height = world.GetWorldHeight();
+	for (uint p = 0; p < mPools.size(); p++) {
+		Pool& pool = mPools[p];
+		uint n = (uint)pool.x.size();
+		if (n == 0) continue;
+		float decay = max(1.0f - pool.emitter->drag * dt, 0.0f);
+		float* x = &pool.x[0];
+		float* y = &pool.y[0];
+		float* vx = &pool.vx[0];
+		float* vy = &pool.vy[0];
+		float* age = &pool.age[0];
+		const float* life = &pool.life[0];
+
+		uint i = 0;
+#ifdef PARTICLES_USE_SSE
+		// Four particles at a time. Wrapping adds or subtracts the world's
+		// size where a particle has crossed an edge, without branching.
+		__m128 dt4 = _mm_set1_ps(dt);
+		__m128 decay4 = _mm_set1_ps(decay);
+		__m128 width4 = _mm_set1_ps(width);
+		__m128 height4 = _mm_set1_ps(height);
+		__m128 max_x4 = _mm_set1_ps(width / 2);
+		__m128 min_x4 = _mm_set1_ps(-width / 2);
+		__m128 max_y4 = _mm_set1_ps(height / 2);
+		__m128 min_y4 = _mm_set1_ps(-height / 2);
+		for (; i + 4 <= n; i += 4) {
+			__m128 vx4 = _mm_loadu_ps(vx + i);
+			__m128 vy4 = _mm_loadu_ps(vy + i);
+			__m128 x4 = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(vx4, dt4));
+			__m128 y4 = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(vy4, dt4));
+			x4 = _mm_add_ps(x4, _mm_and_ps(_mm_cmplt_ps(x4, min_x4), width4));
+			x4 = _mm_sub_ps(x4, _mm_and_ps(_mm_cmpgt_ps(x4, max_x4), width4));
+			y4 = _mm_add_ps(y4, _mm_and_ps(_mm_cmplt_ps(y4, min_y4), height4));
+			y4 = _mm_sub_ps(y4, _mm_and_ps(_mm_cmpgt_ps(y4, max_y4), height4));
+			_mm_storeu_ps(x + i, x4);
+			_mm_storeu_ps(y + i, y4);
+			_mm_storeu_ps(vx + i, _mm_mul_ps(vx4, decay4));
+			_mm_storeu_ps(vy + i, _mm_mul_ps(vy4, decay4));
+			_mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt4));
+		}
+#endif
+		// The rest one at a time, with the same arithmetic
+		for (; i < n; i++) {
+			x[i] += vx[i] * dt;
+			y[i] += vy[i] * dt;
+			if (x[i] < -width / 2) x[i] += width;
+			if (x[i] > width / 2) x[i] -= width;
+			if (y[i] < -height / 2) y[i] += height;
+			if (y[i] > height / 2) y[i] -= height;
+			vx[i] *= decay;
+			vy[i] *= decay;
+			age[i] += dt;
+		}
+
+		// Drop the particles that have died, keeping the rest in order
+		uint live = 0;
+		for (i = 0; i < n; i++) {
+			if (age[i] >= life[i]) continue;
+			x[live] = x[i];
+			y[live] = y[i];
+			vx[live] = vx[i];
+			vy[live] = vy[i];
+			age[live] = age[i];
+			pool.life[live] = life[i];
+			live++;
+		}
+		pool.x.resize(live);
+		pool.y.resize(live);
+		pool.vx.resize(live);
+		pool.vy.resize(live);
+		pool.age.resize(live);
+		pool.life.resize(live);
+	}
+
+	// Free the pools of emitters that nothing else holds once their last
+	// particles have died, so emitters that are replaced, like each new
+	// spaceship's thruster, don't leave their storage behind
+	for (uint p = 0; p < mPools.size(); ) {
+		if (mPools[p].x.empty() && mPools[p].emitter.use_count() == 1) mPools.erase(mPools.begin() + p);
+		else p++;
+	}
+}
+
+/** Remove every particle, keeping the storage for later bursts. */
+void ParticleSystem::Clear()
+{
+	for (uint p = 0; p < mPools.size(); p++) {
+		Pool& pool = mPools[p];
+		pool.x.clear();
+		pool.y.clear();
+		pool.vx.clear();
+		pool.vy.clear();
+		pool.age.clear();
+		pool.life.clear();
+		pool.num_vertices = 0;
+	}
+}
+
+/** Work out the vertices to draw the particles in the world's view with.
+	Each particle is drawn where it is nearest the view, so particles
+	across an edge of the world from the view are drawn there. */
+void ParticleSystem::BuildRenderBatches(const GameWorld& world)
+{
+	const GLVector3f& centre = world.GetViewCentre();
+	float width = world.GetWorldWidth();
+	float height = world.GetWorldHeight();
+	for (uint p = 0; p < mPools.size(); p++) {
+		Pool& pool = mPools[p];
+		const ParticleEmitter& emitter = *pool.emitter;
+		uint n = (uint)pool.x.size();
+		pool.num_vertices = 0;
+		if (n == 0) continue;
+		if (pool.vertices.size() < n * VERTEX_FLOATS) pool.vertices.resize(n * VERTEX_FLOATS);
+
+		float reach_x = world.GetViewWidth() / 2 + emitter.size;
+		float reach_y = world.GetViewHeight() / 2 + emitter.size;
+		GLVector3f fade = emitter.end_colour - emitter.start_colour;
+		GLfloat* vertex = &pool.vertices[0];
+		for (uint i = 0; i < n; i++) {
+			float dx = pool.x[i] - centre.x;
+			float dy = pool.y[i] - centre.y;
+			if (dx > width / 2) dx -= width; else if (dx < -width / 2) dx += width;
+			if (dy > height / 2) dy -= height; else if (dy < -height / 2) dy += height;
+			if (fabs(dx) > reach_x || fabs(dy) > reach_y) continue;
+			float f = pool.age[i] / pool.life[i];
+			vertex[0] = centre.x + dx;
+			vertex[1] = centre.y + dy;
+			vertex[2] = emitter.start_colour.x + fade.x * f;
+			vertex[3] = emitter.start_colour.y + fade.y * f;
+			vertex[4] = emitter.start_colour.z + fade.z * f;
+			vertex[5] = 1.0f - f;
+			vertex += VERTEX_FLOATS;
+			pool.num_vertices++;
+		}
+	}
+}
+
+/** Draw the particles found by the last BuildRenderBatches(), one draw
+	call per emitter. Particles add their light to what is behind them. */
+void ParticleSystem::Render(void)
+{
+	glDisable(GL_LIGHTING);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	glEnable(GL_BLEND);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	for (uint p = 0; p < mPools.size(); p++) {
+		const Pool& pool = mPools[p];
+		if (pool.num_vertices == 0) continue;
+		glPointSize(pool.emitter->size);
+		glVertexPointer(2, GL_FLOAT, VERTEX_FLOATS * sizeof(GLfloat), &pool.vertices[0]);
+		glColorPointer(4, GL_FLOAT, VERTEX_FLOATS * sizeof(GLfloat), &pool.vertices[2]);
+		glDrawArrays(GL_POINTS, 0, pool.num_vertices);
+	}
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glPointSize(1);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_BLEND);
+	glEnable(GL_LIGHTING);
+}
+
+/** Get the number of live particles. */
+uint ParticleSystem::GetNumParticles() const
+{
+	uint count = 0;
+	for (uint p = 0; p < mPools.size(); p++) count += (uint)mPools[p].x.size();
+	return count;
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Get the pool for an emitter's particles, making it the first time. */
+ParticleSystem::Pool& ParticleSystem::GetPool(const shared_ptr<ParticleEmitter>& emitter)
+{
+	for (uint p = 0; p < mPools.size(); p++) {
+		if (mPools[p].emitter == emitter) return mPools[p];
+	}
+
+	mPools.push_back(Pool());
+	Pool& pool = mPools.back();
+	pool.emitter = emitter;
+	uint max_particles = emitter->max_particles;
+	pool.x.reserve(max_particles);
+	pool.y.reserve(max_particles);
+	pool.vx.reserve(max_particles);
+	pool.vy.reserve(max_particles);
+	pool.age.reserve(max_particles);
+	pool.life.reserve(max_particles);
+	pool.vertices.reserve(max_particles * VERTEX_FLOATS);
+	pool.num_vertices = 0;
+	return pool;
+}
+
+/** Get a random number between the given values. */
+float ParticleSystem::Random(float min_value, float max_value)
+{
+	float f = (float)(mRandom() - mRandom.min()) / (float)(mRandom.max() - mRandom.min());
+	return min_value + (max_value - min_value) * f;
+}
@@ -0,0 +1,103 @@
+#ifndef __PARTICLESYSTEM_H__
+#define __PARTICLESYSTEM_H__
+
+#include <random>
+#include "GameUtil.h"
+
+class GameWorld;
+
+// How the particles from an emitter move and look. Emitters are shared by
+// everything that emits them, like shapes and animations are.
+struct ParticleEmitter
+{
+	ParticleEmitter()
+		: count(1), rate(0), min_speed(0), max_speed(0), spread(180), min_life(1), max_life(1),
+		  drag(0), size(1), start_colour(1, 1, 1), end_colour(1, 1, 1), max_particles(4096) {}
+
+	// Particles started by each burst, unless the burst gives its own count
+	uint count;
+	// Particles per second for emitters that emit steadily, such as
+	// exhaust, rather than in one burst
+	float rate;
+	// Speed of new particles, in units per second, relative to the
+	// velocity they are emitted with
+	float min_speed;
+	float max_speed;
+	// Degrees either side of the burst's angle that particles leave at; 180
+	// sends them in every direction
+	float spread;
+	// Seconds each particle lives for
+	float min_life;
+	float max_life;
+	// Fraction of its speed a particle loses each second
+	float drag;
+	// Size of each particle in pixels
+	float size;
+	// Colour of a particle when it starts and when it dies. Particles fade
+	// out as they age.
+	GLVector3f start_colour;
+	GLVector3f end_colour;
+	// Most particles from the emitter alive at once; bursts beyond this
+	// are cut short
+	uint max_particles;
+};
+
+// A burst of particles from an emitter, leaving a position at an angle in
+// degrees, carried along with a velocity.
+struct ParticleBurst
+{
+	shared_ptr<ParticleEmitter> emitter;
+	GLVector3f position;
+	GLVector3f velocity;
+	float angle;
+	uint count;
+};
+
+// Particles for effects such as explosions and exhaust, which only move
+// and fade. Particles aren't game objects: they don't collide or have
+// listeners, and each emitter's particles are kept as arrays of each
+// field, updated a few at a time with SIMD instructions where the
+// compiler supports them, and drawn with a single draw call. Particles
+// wrap at the world's edges like objects do.
+class ParticleSystem
+{
+public:
+	ParticleSystem();
+	~ParticleSystem();
+
+	void Emit(const ParticleBurst& burst);
+	void Update(int t, const GameWorld& world);
+	void Clear();
+
+	void BuildRenderBatches(const GameWorld& world);
+	void Render(void);
+
+	uint GetNumParticles() const;
+
+private:
+	// The live particles from one emitter, oldest first, and the vertices
+	// to draw them with
+	struct Pool
+	{
+		shared_ptr<ParticleEmitter> emitter;
+		vector<float> x;
+		vector<float> y;
+		vector<float> vx;
+		vector<float> vy;
+		vector<float> age;
+		vector<float> life;
+		// Position and colour of each particle to draw, interleaved
+		vector<GLfloat> vertices;
+		uint num_vertices;
+	};
+
+	Pool& GetPool(const shared_ptr<ParticleEmitter>& emitter);
+	float Random(float min_value, float max_value);
+
+	vector<Pool> mPools;
+	// Particles must be the same whatever the number of threads, so they
+	// draw from their own generator
+	minstd_rand mRandom;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "Profiler.h"
+
+using namespace std;
+
+atomic<bool> Profiler::mEnabled(false);
+
+// PRIVATE INSTANCE CONSTRUCTORS //////////////////////////////////////////////
+
+/** Constructor. */
+Profiler::Profiler(void)
+	: mFrames(HISTORY_SIZE),
+	  mCurrentFrame(0),
+	  mNumFrames(0),
+	  mFrameStarted(false),
+	  mFrameStart(0),
+	  mEpoch(chrono::high_resolution_clock::now())
+{
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Turn recording on or off. History is kept when recording is turned off. */
+void Profiler::SetEnabled(bool enabled)
+{
+	mEnabled.store(enabled, memory_order_relaxed);
+	mFrameStarted = false;
+	mStack.clear();
+}
+
+/** Finish the current frame and start recording the next one. Must be
+	called once per frame from the thread running the game loop. */
+void Profiler::NewFrame(void)
+{
+	if (!IsEnabled()) return;
+
+	double now = GetTime();
+	if (mFrameStarted) {
+		mFrames[mCurrentFrame].duration = now - mFrameStart;
+		mCurrentFrame = (mCurrentFrame + 1) % HISTORY_SIZE;
+		if (mNumFrames < HISTORY_SIZE) mNumFrames++;
+	}
+
+	// Clearing keeps the capacity, so steady state recording doesn't allocate
+	mFrames[mCurrentFrame].samples.clear();
+	mFrames[mCurrentFrame].duration = 0;
+	mStack.clear();
+	mFrameStart = now;
+	mFrameStarted = true;
+	mFrameThread = this_thread::get_id();
+}
+
+/** Open a named scope. Returns false if the scope was not recorded. */
+bool Profiler::BeginScope(const char* name)
+{
+	if (!mFrameStarted || this_thread::get_id() != mFrameThread) return false;
+
+	ProfileSample sample;
+	sample.name = name;
+	sample.depth = (uint)mStack.size();
+	sample.start = GetTime() - mFrameStart;
+	sample.duration = 0;
+
+	vector<ProfileSample>& samples = mFrames[mCurrentFrame].samples;
+	mStack.push_back((uint)samples.size());
+	samples.push_back(sample);
+	return true;
+}
+
+/** Close the most recently opened scope. */
+void Profiler::EndScope(void)
+{
+	// The frame may have been restarted while the scope was open
+	if (mStack.empty()) return;
+	ProfileSample& sample = mFrames[mCurrentFrame].samples[mStack.back()];
+	sample.duration = GetTime() - mFrameStart - sample.start;
+	mStack.pop_back();
+}
+
+/** Get a completed frame, where 0 is the most recent. Returns NULL if that
+	frame is no longer (or not yet) in the history. */
+const FrameProfile* Profiler::GetFrame(uint frames_ago) const
+{
+	if (frames_ago >= mNumFrames) return NULL;
+	uint index = (mCurrentFrame + HISTORY_SIZE - 1 - frames_ago) % HISTORY_SIZE;
+	return &mFrames[index];
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Get the time in milliseconds since the profiler was created. */
+double Profiler::GetTime(void) const
+{
+	return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - mEpoch).count();
+}
@@ -0,0 +1,111 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "AllocationTracker.h"
+#include "TraceRecorder.h"
+
+typedef unsigned int uint;
+
+// A single timed scope within a frame. Times are in milliseconds
+// relative to the start of the frame.
+struct ProfileSample
+{
+	const char* name;
+	uint depth;
+	double start;
+	double duration;
+};
+
+// All scopes recorded during one frame, in the order they were opened
+struct FrameProfile
+{
+	double duration;
+	std::vector<ProfileSample> samples;
+};
+
+class Profiler
+{
+public:
+	// Number of frames kept in the history ring buffer
+	static const uint HISTORY_SIZE = 120;
+
+	inline static Profiler& GetInstance(void)
+	{
+		static Profiler mInstance;
+		return mInstance;
+	}
+
+	inline static bool IsEnabled(void) { return mEnabled.load(std::memory_order_relaxed); }
+	void SetEnabled(bool enabled);
+
+	void NewFrame(void);
+	bool BeginScope(const char* name);
+	void EndScope(void);
+
+	uint GetNumFrames(void) const { return mNumFrames; }
+	const FrameProfile* GetFrame(uint frames_ago) const;
+
+private:
+	Profiler(void);
+	~Profiler(void) {}
+
+	double GetTime(void) const;
+
+	std::vector<FrameProfile> mFrames;
+	uint mCurrentFrame;
+	uint mNumFrames;
+	bool mFrameStarted;
+	double mFrameStart;
+
+	// Indices of the samples that are still open
+	std::vector<uint> mStack;
+
+	// Only scopes opened on the thread running the frame are recorded
+	std::thread::id mFrameThread;
+	std::chrono::high_resolution_clock::time_point mEpoch;
+
+	// Checked by scopes opened on any thread
+	static std::atomic<bool> mEnabled;
+};
+
+// Times the enclosing block when the profiler is enabled, records it as a
+// span on the calling thread when the trace recorder is enabled, and
+// attributes allocations to it when the allocation tracker is enabled
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name)
+		: mName(name),
+		  mActive(Profiler::IsEnabled() && Profiler::GetInstance().BeginScope(name)),
+		  mTraced(TraceRecorder::IsEnabled()),
+		  mAllocationScope(name)
+	{
+		if (mTraced) mTraceStart = TraceRecorder::GetInstance().GetTime();
+	}
+	~ProfileScope()
+	{
+		if (mActive) Profiler::GetInstance().EndScope();
+		if (mTraced) TraceRecorder::GetInstance().AddSpan(mName, mTraceStart);
+	}
+private:
+	const char* mName;
+	bool mActive;
+	bool mTraced;
+	double mTraceStart;
+	AllocationScope mAllocationScope;
+};
+
+// Define DISABLE_PROFILER to compile all profiling scopes out
+#ifdef DISABLE_PROFILER
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE_CONCAT2(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_CONCAT(profile_scope_, __LINE__)(name)
+#endif
+
+#endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include "GUILabel.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Default constructor. */
+ProfilerOverlay::ProfilerOverlay() : mVisibleLines(0), mFramesUntilRefresh(0)
+{
+	mHorizontalAlignment = GUI_HALIGN_RIGHT;
+	mVerticalAlignment = GUI_VALIGN_TOP;
+}
+
+/** Destructor. */
+ProfilerOverlay::~ProfilerOverlay()
+{
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Draw the timings of the most recent frame, one line per scope. */
+void ProfilerOverlay::Draw()
+{
+	if (!mVisible) return;
+
+	if (mFramesUntilRefresh == 0) {
+		UpdateText();
+		mFramesUntilRefresh = REFRESH_FRAMES;
+	}
+	mFramesUntilRefresh--;
+
+	for (uint i = 0; i < mVisibleLines; i++) {
+		mLines[i]->Draw();
+	}
+}
+
+/** Set the position of the top line; further lines are laid out below. */
+void ProfilerOverlay::SetPosition(const GLVector2i& position)
+{
+	GUIComponent::SetPosition(position);
+	for (uint i = 0; i < mLines.size(); i++) {
+		mLines[i]->SetPosition(GLVector2i(mPosition.x, mPosition.y - i * LINE_HEIGHT));
+	}
+}
+
+// PROTECTED INSTANCE METHODS /////////////////////////////////////////////////
+
+/** Rebuild the label text from the profiler's most recent frame. */
+void ProfilerOverlay::UpdateText()
+{
+	const FrameProfile* frame = Profiler::GetInstance().GetFrame(0);
+	if (frame == NULL) {
+		mVisibleLines = 0;
+		return;
+	}
+
+	// Show the last frame's allocations under the frame time when counting
+	bool allocations = AllocationTracker::IsEnabled();
+	uint first_sample_line = allocations ? 2 : 1;
+	uint num_lines = (uint)frame->samples.size() + first_sample_line;
+	while (mLines.size() < num_lines) {
+		shared_ptr<GUILabel> label = make_shared<GUILabel>();
+		label->SetHorizontalAlignment(mHorizontalAlignment);
+		label->SetVerticalAlignment(mVerticalAlignment);
+		label->SetBorder(mBorder);
+		label->SetColor(mColor);
+		label->SetPosition(GLVector2i(mPosition.x, mPosition.y - (int)mLines.size() * LINE_HEIGHT));
+		mLines.push_back(label);
+	}
+
+	char text[128];
+	snprintf(text, sizeof(text), "Frame %6.2f ms", frame->duration);
+	mLines[0]->SetText(text);
+	if (allocations) {
+		const AllocationFrame& alloc_frame = AllocationTracker::GetInstance().GetLastFrame();
+		snprintf(text, sizeof(text), "Allocs %6u %8.1f KB", alloc_frame.allocations, alloc_frame.bytes / 1024.0);
+		mLines[1]->SetText(text);
+	}
+	for (uint i = 0; i < frame->samples.size(); i++) {
+		const ProfileSample& sample = frame->samples[i];
+		// Indent each scope by its depth in the hierarchy
+		snprintf(text, sizeof(text), "%*s%s %6.2f ms", sample.depth * 2, "", sample.name, sample.duration);
+		mLines[i + first_sample_line]->SetText(text);
+	}
+	mVisibleLines = num_lines;
+}
@@ -0,0 +1,30 @@
+#ifndef __PROFILEROVERLAY_H__
+#define __PROFILEROVERLAY_H__
+
+#include "GameUtil.h"
+#include "GUIComponent.h"
+
+class GUILabel;
+
+class ProfilerOverlay : public GUIComponent
+{
+public:
+	ProfilerOverlay();
+	virtual ~ProfilerOverlay();
+	virtual void Draw();
+
+	virtual void SetPosition(const GLVector2i& position);
+
+protected:
+	void UpdateText();
+
+	vector< shared_ptr<GUILabel> > mLines;
+	uint mVisibleLines;
+	uint mFramesUntilRefresh;
+
+	// Number of frames between refreshes so the numbers stay readable
+	static const uint REFRESH_FRAMES = 15;
+	static const int LINE_HEIGHT = 15;
+};
+
+#endif
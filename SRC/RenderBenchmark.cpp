@@ -0,0 +1,253 @@
+// Offscreen render benchmark for build machines without a GPU or display.
+//
+// Renders a scripted scene of sprite asteroids, a shooting spaceship,
+// bullet shapes, explosions, particles and (optionally) GUI labels into an
+// OffscreenContext, and reports frame time statistics. Run it from the
+// directory holding the game assets.
+//
+// Usage: RenderBenchmark [options]
+//   --frames <n>             frames to render (default 600)
+//   --warmup <n>             untimed frames rendered first (default 10)
+//   --size <w>x<h>           frame buffer size (default 800x800)
+//   --asteroids <n>          asteroids in the scene (default 50)
+//   --unbatched              give each asteroid a sprite of its own and
+//                            draw it with the asteroid, rather than sharing
+//                            one sprite and drawing them in batches
+//   --capture-every <n>      save every nth frame as a PNG (default off)
+//   --capture-prefix <name>  file name prefix for captures (default frame)
+//   --frame-times <file>     write every frame's time to a CSV file
+//   --gui                    render GUILabels; GLUT bitmap fonts need
+//                            glutInit, which freeglut only allows with a
+//                            display (Xvfb is enough)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <climits>
+#include <algorithm>
+#include <chrono>
+#include "GameUtil.h"
+#include "GameWorld.h"
+#include "GameDisplay.h"
+#include "GameObject.h"
+#include "Animation.h"
+#include "AnimationManager.h"
+#include "Asteroid.h"
+#include "Spaceship.h"
+#include "Explosion.h"
+#include "ParticleEffects.h"
+#include "BoundingSphere.h"
+#include "GUILabel.h"
+#include "OffscreenContext.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+// Zoom between frame buffer pixels and world units, as used by GameWindow
+static const int ZOOM_LEVEL = 3;
+
+// Options that control the scene and how it is rendered
+struct RenderBenchmarkOptions
+{
+	RenderBenchmarkOptions()
+		: frames(600), warmup(10), width(800), height(800), asteroids(50), capture_every(0),
+		  capture_prefix("frame"), unbatched(false), gui(false) {}
+
+	uint frames;
+	uint warmup;
+	uint width;
+	uint height;
+	uint asteroids;
+	uint capture_every;
+	string capture_prefix;
+	string frame_times;
+	bool unbatched;
+	bool gui;
+};
+
+/** Parse command line options, returning false on an unknown option. */
+static bool ParseOptions(int argc, char* argv[], RenderBenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--frames" && has_value) {
+			options.frames = (uint)atoi(argv[++i]);
+		} else if (arg == "--warmup" && has_value) {
+			options.warmup = (uint)atoi(argv[++i]);
+		} else if (arg == "--size" && has_value) {
+			if (sscanf(argv[++i], "%ux%u", &options.width, &options.height) != 2) return false;
+		} else if (arg == "--asteroids" && has_value) {
+			options.asteroids = (uint)atoi(argv[++i]);
+		} else if (arg == "--capture-every" && has_value) {
+			options.capture_every = (uint)atoi(argv[++i]);
+		} else if (arg == "--capture-prefix" && has_value) {
+			options.capture_prefix = argv[++i];
+		} else if (arg == "--frame-times" && has_value) {
+			options.frame_times = argv[++i];
+		} else if (arg == "--unbatched") {
+			options.unbatched = true;
+		} else if (arg == "--gui") {
+			options.gui = true;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Create a sprite playing the named animation. */
+static shared_ptr<Sprite> CreateSprite(const string& name, bool loop)
+{
+	Animation* anim_ptr = AnimationManager::GetInstance().GetAnimationByName(name);
+	shared_ptr<Sprite> sprite = make_shared<Sprite>(anim_ptr->GetWidth(), anim_ptr->GetHeight(), anim_ptr);
+	sprite->SetLoopAnimation(loop);
+	sprite->SetClocked(true);
+	return sprite;
+}
+
+/** Build the scene the same way the game does. */
+static shared_ptr<Spaceship> CreateScene(GameWorld& world, GameDisplay& display, const RenderBenchmarkOptions& options)
+{
+	AnimationManager::GetInstance().CreateAnimationFromFile("explosion", 64, 1024, 64, 64, "explosion_fs.png");
+	AnimationManager::GetInstance().CreateAnimationFromFile("asteroid1", 128, 8192, 128, 128, "asteroid1_fs.png");
+	AnimationManager::GetInstance().CreateAnimationFromFile("spaceship", 128, 128, 128, 128, "spaceship_fs.png");
+
+	shared_ptr<Spaceship> spaceship = make_shared<Spaceship>();
+	spaceship->SetBoundingShape(make_shared<BoundingSphere>(spaceship->GetThisPtr(), 4.0f));
+	spaceship->SetBulletShape(make_shared<Shape>("bullet.shape"));
+	spaceship->SetThrusterEmitter(CreateThrusterEmitter());
+	spaceship->SetSprite(CreateSprite("spaceship", true));
+	spaceship->SetScale(0.1f);
+	spaceship->Reset();
+	spaceship->Thrust(0);
+	// Keep the spaceship in the scene for the whole run
+	spaceship->ActivateInvulnerability(INT_MAX);
+	world.AddObject(spaceship);
+
+	shared_ptr<Sprite> asteroid_sprite = CreateSprite("asteroid1", true);
+	for (uint i = 0; i < options.asteroids; i++) {
+		shared_ptr<GameObject> asteroid = make_shared<Asteroid>();
+		asteroid->SetBoundingShape(make_shared<BoundingSphere>(asteroid->GetThisPtr(), 10.0f));
+		if (options.unbatched) {
+			asteroid->SetSprite(CreateSprite("asteroid1", true));
+		} else {
+			asteroid->SetSprite(asteroid_sprite);
+			asteroid->SetSpritePhase(asteroid_sprite->GetDuration() * (rand() % 1000) / 1000.0);
+			asteroid->SetBatchedSprite(true);
+		}
+		asteroid->SetScale(0.2f);
+		world.AddObject(asteroid);
+	}
+
+	if (options.gui) {
+		const char* lines[] = { "ASTEROIDS", "Score: 1230", "Lives: 3", "Level 4" };
+		for (uint i = 0; i < 4; i++) {
+			shared_ptr<GUILabel> label = make_shared<GUILabel>(lines[i]);
+			label->SetHorizontalAlignment(GUIComponent::GUI_HALIGN_CENTER);
+			display.GetContainer()->AddComponent(label, GLVector2f(0.5f, 0.9f - 0.1f * i));
+		}
+	}
+
+	return spaceship;
+}
+
+/** Advance the scripted scene by one frame. */
+static void ScriptFrame(uint frame, GameWorld& world, shared_ptr<Spaceship> spaceship)
+{
+	// Fly in a circle, thrusting for one second in every two
+	spaceship->Rotate(90);
+	spaceship->Thrust((frame / 60) % 2 == 0 ? 10.0f : 0.0f);
+	if (frame % 5 == 0) spaceship->Shoot();
+
+	// Add an explosion on one side of the spaceship twice a second, and
+	// break an asteroid up into particles on the other
+	if (frame % 30 == 0) {
+		static shared_ptr<ParticleEmitter> explosion_emitter = CreateExplosionEmitter();
+		static shared_ptr<ParticleEmitter> debris_emitter = CreateDebrisEmitter();
+		shared_ptr<GameObject> explosion = make_shared<Explosion>();
+		explosion->SetSprite(CreateSprite("explosion", false));
+		explosion->Reset();
+		explosion->SetPosition(spaceship->GetPosition() + GLVector3f(20, 0, 0));
+		world.AddObject(explosion);
+		world.EmitParticles(explosion_emitter, spaceship->GetPosition() - GLVector3f(20, 0, 0), GLVector3f(0, 0, 0), 0);
+		world.EmitParticles(debris_emitter, spaceship->GetPosition() - GLVector3f(20, 0, 0), GLVector3f(0, 0, 0), 0);
+	}
+}
+
+/** Get the value at the given fraction through a sorted list. */
+static double Percentile(const vector<double>& sorted, double fraction)
+{
+	uint index = (uint)(fraction * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+int main(int argc, char* argv[])
+{
+	RenderBenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options) || options.frames == 0) {
+		cerr << "Usage: RenderBenchmark [--frames n] [--warmup n] [--size wxh] [--asteroids n] [--capture-every n]"
+			" [--capture-prefix name] [--frame-times file] [--unbatched] [--gui]" << endl;
+		return 1;
+	}
+
+	OffscreenContext context(options.width, options.height);
+	if (!context.IsValid()) return 1;
+	if (options.gui) glutInit(&argc, argv);
+
+	srand(1);
+	GameWorld world;
+	world.SetWidth(options.width / ZOOM_LEVEL);
+	world.SetHeight(options.height / ZOOM_LEVEL);
+	GameDisplay display(options.width, options.height);
+	display.Reshape(options.width, options.height);
+	glViewport(0, 0, options.width, options.height);
+
+	// Match the lighting set up by the game
+	GLfloat ambient_light[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	GLfloat diffuse_light[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glLightfv(GL_LIGHT0, GL_AMBIENT, ambient_light);
+	glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse_light);
+	glEnable(GL_LIGHT0);
+
+	shared_ptr<Spaceship> spaceship = CreateScene(world, display, options);
+
+	// Warm up first so texture uploads and driver setup are not timed
+	vector<double> frame_times;
+	frame_times.reserve(options.frames);
+	for (uint frame = 0; frame < options.warmup + options.frames; frame++) {
+		ScriptFrame(frame, world, spaceship);
+		world.Update(16);
+
+		Clock::time_point start = Clock::now();
+		glClear(GL_COLOR_BUFFER_BIT);
+		world.Render();
+		display.Render();
+		context.Finish();
+		if (frame < options.warmup) continue;
+		frame_times.push_back(chrono::duration<double, milli>(Clock::now() - start).count());
+
+		uint timed_frame = frame - options.warmup;
+		if (options.capture_every > 0 && timed_frame % options.capture_every == 0) {
+			char filename[256];
+			snprintf(filename, sizeof(filename), "%s-%05u.png", options.capture_prefix.c_str(), timed_frame);
+			if (!context.SaveFrame(filename)) cerr << "Error saving " << filename << endl;
+		}
+	}
+
+	if (!options.frame_times.empty()) {
+		ofstream file(options.frame_times.c_str());
+		file << "frame,render_ms" << endl;
+		for (uint i = 0; i < frame_times.size(); i++) file << i << ',' << frame_times[i] << '\n';
+	}
+
+	double total = 0;
+	for (uint i = 0; i < frame_times.size(); i++) total += frame_times[i];
+	vector<double> sorted = frame_times;
+	sort(sorted.begin(), sorted.end());
+
+	printf("Rendered %u frames at %ux%u with %u asteroids%s\n", options.frames, options.width, options.height,
+		options.asteroids, options.gui ? " and GUI labels" : "");
+	printf("%10s %10s %10s %10s %10s %10s   (ms/frame)\n", "mean", "min", "median", "p95", "p99", "max");
+	printf("%10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", total / frame_times.size(), sorted.front(),
+		Percentile(sorted, 0.5), Percentile(sorted, 0.95), Percentile(sorted, 0.99), sorted.back());
+	return 0;
+}
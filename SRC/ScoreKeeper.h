@@ -19,7 +19,8 @@ public:
 
 	void OnObjectRemoved(GameWorld *world, shared_ptr<GameObject> object)
 	{
-		if (object->GetType() == GameObjectType("Asteroid"))
+		// Asteroids without a bounding shape are only scenery
+		if (object->GetType() == GameObjectType("Asteroid") && object->GetBoundingShape().get() != NULL)
 		{
 			mScore += 10;
 			FireScoreChanged();
@@ -3,11 +3,11 @@
 
 using namespace std;
 
-Shape::Shape()
+Shape::Shape() : mRadius(0)
 {
 }
 
-Shape::Shape(const string& shape_filename)
+Shape::Shape(const string& shape_filename) : mRadius(0)
 {
 	LoadShape(shape_filename);
 }
@@ -27,8 +27,7 @@ void Shape::Render(void)
 	glColor3f(mRGB[0], mRGB[1], mRGB[2]);
 	// Add vertices to draw shape
 	for (GLVector2fList::iterator it = mPoints.begin(); it != mPoints.end(); ++it) {
-		shared_ptr<GLVector2f> vec = (*it);
-		glVertex2f(vec->x, vec->y);
+		glVertex2f(it->x, it->y);
 	}
 	// Finish drawing lines
 	glEnd();
@@ -54,8 +53,8 @@ void Shape::LoadShape(const string& shape_filename)
 	while (!shape_file.eof()) {
 		float x, y;
 		shape_file >> x >> y;
-		shared_ptr<GLVector2f> vec(new GLVector2f(x, y));
-		mPoints.push_back(vec);
+		mPoints.push_back(GLVector2f(x, y));
+		mRadius = max(mRadius, (float)sqrt(x * x + y * y));
 	}
 
 }
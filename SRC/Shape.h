@@ -5,7 +5,7 @@
 
 using namespace std;
 
-typedef list< shared_ptr<GLVector2f> > GLVector2fList;
+typedef vector<GLVector2f> GLVector2fList;
 	
 class Shape
 {
@@ -20,11 +20,14 @@ public:
 
 	const GLVector3f& GetRGBColour() { return mRGB; }
 	const GLVector2fList& GetPoints() { return mPoints; } 
+	float GetRadius() const { return mRadius; }
 
 private:
 	bool mLoop;
 	GLVector3f mRGB;
 	GLVector2fList mPoints;
+	// Distance of the furthest point from the origin
+	float mRadius;
 };
 
 #endif
\ No newline at end of file
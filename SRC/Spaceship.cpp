@@ -13,6 +13,7 @@ using namespace std;
 //Modified version of constructor for setting default values 
 Spaceship::Spaceship()
 	: GameObject("Spaceship"),
+	mThrusterParticles(0),
 	mIsInvulnerable(false),
 	mInvulnerabilityTime(0),
 	mInvulnerabilityTimer(0),
@@ -23,13 +24,13 @@ Spaceship::Spaceship()
 
 /** Construct a spaceship with given position, velocity, acceleration, angle, and rotation. */
 Spaceship::Spaceship(GLVector3f p, GLVector3f v, GLVector3f a, GLfloat h, GLfloat r)
-	: GameObject("Spaceship", p, v, a, h, r), mThrust(0)
+	: GameObject("Spaceship", p, v, a, h, r), mThrust(0), mThrusterParticles(0)
 {
 }
 
 /** Copy constructor. */
 Spaceship::Spaceship(const Spaceship& s)
-	: GameObject(s), mThrust(0)
+	: GameObject(s), mThrust(0), mThrusterParticles(0)
 {
 }
 
@@ -40,7 +41,7 @@ Spaceship::~Spaceship(void)
 
 // PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
 
-/** Update this spaceship. */
+/** Update this spaceship, leaving exhaust behind it while it thrusts. */
 
 // modified to Update invulnerability timer and braking system
 void Spaceship::Update(int t)
@@ -48,6 +49,15 @@ void Spaceship::Update(int t)
 	GameObject::Update(t);
 	UpdateInvulnerability(t);
 
+	if (mWorld && mThrust > 0 && mThrusterEmitter.get() != NULL) {
+		// Emit at the emitter's rate however long the update was, carrying
+		// any fraction of a particle over to the next update
+		mThrusterParticles += mThrusterEmitter->rate * t / 1000.0f;
+		uint count = (uint)mThrusterParticles;
+		mThrusterParticles -= count;
+		if (count > 0) mWorld->EmitParticles(mThrusterEmitter, mPosition - GetHeading() * 4, mVelocity, mAngle + 180, count);
+	}
+
 	if (mIsBraking) {
 		ApplyBrake();
 	}
@@ -60,20 +70,24 @@ void Spaceship::Render(void)
 	if (mIsInvulnerable && !mIsVisible) return; // Skip rendering during blink
 
 	if (mSpaceshipShape.get() != NULL) mSpaceshipShape->Render();
-	if ((mThrust > 0) && (mThrusterShape.get() != NULL)) {
-		mThrusterShape->Render();
-	}
 	GameObject::Render();
 }
 
+/** Get the radius the spaceship draws within, including its shapes. */
+float Spaceship::GetRenderRadius(void)
+{
+	float radius = GameObject::GetRenderRadius();
+	if (mSpaceshipShape.get() != NULL) radius = max(radius, mSpaceshipShape->GetRadius() * mScale);
+	return radius;
+}
+
 /** Fire the rockets. */
 
 void Spaceship::Thrust(float t)
 {
 	mThrust = t;
 	if (t > 0) {
-		mAcceleration.x = mThrust * cos(DEG2RAD * mAngle);
-		mAcceleration.y = mThrust * sin(DEG2RAD * mAngle);
+		mAcceleration = GetHeading() * mThrust;
 	}
 	else {
 		mAcceleration = GLVector3f(0, 0, 0);
@@ -92,8 +106,7 @@ void Spaceship::Shoot(void)
 	// Check the world exists
 	if (!mWorld) return;
 	// Construct a unit length vector in the direction the spaceship is headed
-	GLVector3f spaceship_heading(cos(DEG2RAD*mAngle), sin(DEG2RAD*mAngle), 0);
-	spaceship_heading.normalize();
+	const GLVector3f& spaceship_heading = GetHeading();
 	// Calculate the point at the node of the spaceship from position and heading
 	GLVector3f bullet_position = mPosition + (spaceship_heading * 4);
 	// Calculate how fast the bullet should travel
@@ -119,12 +132,12 @@ bool Spaceship::CollisionTest(shared_ptr<GameObject> o)
 }
 
 //Modified this method to set a flag to ignore collision or not 
-void Spaceship::OnCollision(const GameObjectList& objects)
+void Spaceship::OnCollision(const ContactSpan& contacts)
 {
 	if (mIsInvulnerable && mInvulnerabilityEnabled) return; // Skip collision handling if invulnerable
 
-	for (auto obj : objects) {
-		if (obj->GetType() == GameObjectType("Asteroid")) {
+	for (const Contact& contact : contacts) {
+		if (contact.other->GetType() == GameObjectType("Asteroid")) {
 			mWorld->FlagForRemoval(shared_from_this());
 			break;
 		}
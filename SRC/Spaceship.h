@@ -4,6 +4,7 @@
 #include "GameUtil.h"
 #include "GameObject.h"
 #include "Shape.h"
+#include "ParticleSystem.h"
 
 class Spaceship : public GameObject
 {
@@ -15,17 +16,18 @@ public:
 
 	virtual void Update(int t);
 	virtual void Render(void);
+	virtual float GetRenderRadius(void);
 
 	virtual void Thrust(float t);
 	virtual void Rotate(float r);
 	virtual void Shoot(void);
 
 	void SetSpaceshipShape(shared_ptr<Shape> spaceship_shape) { mSpaceshipShape = spaceship_shape; }
-	void SetThrusterShape(shared_ptr<Shape> thruster_shape) { mThrusterShape = thruster_shape; }
+	void SetThrusterEmitter(shared_ptr<ParticleEmitter> thruster_emitter) { mThrusterEmitter = thruster_emitter; }
 	void SetBulletShape(shared_ptr<Shape> bullet_shape) { mBulletShape = bullet_shape; }
 
 	bool CollisionTest(shared_ptr<GameObject> o);
-	void OnCollision(const GameObjectList &objects);
+	void OnCollision(const ContactSpan& contacts);
 
 	//new private members for Implementing Invulnerability   
 	void ActivateInvulnerability(int duration);
@@ -45,7 +47,9 @@ private:
 	float mThrust;
 
 	shared_ptr<Shape> mSpaceshipShape;
-	shared_ptr<Shape> mThrusterShape;
+	shared_ptr<ParticleEmitter> mThrusterEmitter;
+	// Exhaust particles owed but not yet emitted
+	float mThrusterParticles;
 	shared_ptr<Shape> mBulletShape;
 
 	//new  members for Implementing Invulnerability   
@@ -35,7 +35,10 @@ Sprite::Sprite(uint w, uint h, Animation* a, bool l)
 	  mCurrentFrame(0),
 	  mAnimating(true),
 	  mFrameMillis(0),
-	  mMillisPerFrame(1000/12)
+	  mMillisPerFrame(1000/12),
+	  mClocked(false),
+	  mStartTime(0),
+	  mPlaybackRate(1)
 {
 }
 
@@ -47,6 +50,9 @@ Sprite::~Sprite()
 
 void Sprite::Update(int t)
 {
+	// Clocked sprites work out their frame when they are drawn
+	if (mClocked) return;
+
 	mFrameMillis += t;
 	if (mFrameMillis >= mMillisPerFrame) {
 		mFrameMillis = mFrameMillis % mMillisPerFrame;
@@ -63,6 +69,30 @@ void Sprite::Update(int t)
 	}
 }
 
+/** Get the frame a clocked sprite shows at the given time, in seconds.
+	A sprite that doesn't loop goes back to its first frame once it has
+	played through, as it does when it is updated. */
+int Sprite::GetFrameAt(double time) const
+{
+	double millis = (time - mStartTime) * 1000.0 * mPlaybackRate;
+	if (millis <= 0) return 0;
+	int frame = (int)(millis / mMillisPerFrame);
+	if (mLoopAnimation) return frame % mFrames;
+	return frame < mFrames ? frame : 0;
+}
+
+/** Get the time, in seconds, the sprite takes to play through once. */
+double Sprite::GetDuration() const
+{
+	return mFrames * mMillisPerFrame / (1000.0 * mPlaybackRate);
+}
+
+/** Get the texture holding one of the sprite's frames. */
+uint Sprite::GetFrameTextureID(int frame) const
+{
+	return mAnimation->GetFrameTextureID(frame);
+}
+
 /*
 void Sprite::Render()
 {
@@ -89,6 +119,13 @@ void Sprite::Render()
 */
 
 void Sprite::Render()
+{
+	RenderFrame(mCurrentFrame);
+}
+
+/** Draw one of the sprite's frames, whichever frame it is showing. Objects
+	sharing a sprite draw it this way, each at its own frame. */
+void Sprite::RenderFrame(int frame) const
 {
 	float x1 = (float)(-mOffsetX);
 	float y1 = (float)(-mOffsetY);
@@ -98,7 +135,7 @@ void Sprite::Render()
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_BLEND);
 	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, mAnimation->GetFrameTextureID(mCurrentFrame));
+	glBindTexture(GL_TEXTURE_2D, mAnimation->GetFrameTextureID(frame));
 	glBegin(GL_QUADS);
 		glTexCoord2f(0.0f, 0.0f); glVertex3f(x1, y1, 0.0f);
 		glTexCoord2f(1.0f, 0.0f); glVertex3f(x2, y1, 0.0f);
@@ -15,15 +15,32 @@ public:
 
 	virtual void Update(int t);
 	virtual void Render(void);
+	void RenderFrame(int frame) const;
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+	int GetOffsetX() const { return mOffsetX; }
+	int GetOffsetY() const { return mOffsetY; }
+	uint GetFrameTextureID(int frame) const;
 
 	void SetCurrentFrame(int f) { mCurrentFrame = f % mFrames; }
-	int GetCurrentFrame() { return mCurrentFrame; }
+	int GetCurrentFrame() const { return mCurrentFrame; }
 
 	void SetLoopAnimation(bool loop) { mLoopAnimation = loop; }
-	bool GetLoopAnimation() { return mLoopAnimation; }
+	bool GetLoopAnimation() const { return mLoopAnimation; }
 
 	bool IsAnimating() { return mAnimating; }
 
+	void SetClocked(bool clocked) { mClocked = clocked; }
+	bool IsClocked() const { return mClocked; }
+	void SetStartTime(double time) { mStartTime = time; mCurrentFrame = 0; mAnimating = true; }
+	double GetStartTime() const { return mStartTime; }
+	void SetPlaybackRate(float rate) { mPlaybackRate = rate; }
+	float GetPlaybackRate() const { return mPlaybackRate; }
+
+	int GetFrameAt(double time) const;
+	double GetDuration() const;
+
 private:
 	int mWidth;
 	int mHeight;
@@ -40,6 +57,15 @@ private:
 	
 	int mFrameMillis;
 	int mMillisPerFrame;
+
+	// Clocked sprites aren't updated. They only remember when they started
+	// and how fast they play, and show the frame for the clock's time when
+	// they are drawn. Their state doesn't change as they play, so one
+	// clocked sprite can be shared by many objects, each showing it at its
+	// own phase.
+	bool mClocked;
+	double mStartTime;
+	float mPlaybackRate;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include "GameUtil.h"
+#include "GameObject.h"
+#include "Profiler.h"
+#include "Sprite.h"
+#include "SpriteBatch.h"
+
+// Floats per sprite vertex: x, y and texture coordinates
+static const uint VERTEX_FLOATS = 4;
+// Texture coordinates of a quad's corners, in the order Sprite draws them
+static const GLfloat TEX_COORDS[8] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+
+// PUBLIC INSTANCE CONSTRUCTORS ///////////////////////////////////////////////
+
+/** Default constructor. */
+SpriteBatch::SpriteBatch()
+{
+}
+
+/** Destructor. */
+SpriteBatch::~SpriteBatch()
+{
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Remove every sprite, keeping the storage for the next frame. */
+void SpriteBatch::Clear()
+{
+	mQuads.clear();
+	mOrder.clear();
+	mBatches.clear();
+}
+
+/** Add an object's sprite, as the object would draw it, moved by the
+	given offset. */
+void SpriteBatch::Add(GameObject* object, const GLVector3f& offset)
+{
+	const Sprite& sprite = *object->GetSprite();
+	float x1 = (float)-sprite.GetOffsetX();
+	float y1 = (float)-sprite.GetOffsetY();
+	float x2 = (float)(sprite.GetWidth() - sprite.GetOffsetX());
+	float y2 = (float)(sprite.GetHeight() - sprite.GetOffsetY());
+	GLVector2f corners[4] = { GLVector2f(x1, y1), GLVector2f(x2, y1), GLVector2f(x2, y2), GLVector2f(x1, y2) };
+	object->GetTransform().transformPoints(corners, corners, 4);
+
+	Quad quad;
+	quad.texture = sprite.GetFrameTextureID(object->GetSpriteFrame());
+	for (uint i = 0; i < 4; i++) {
+		quad.corners[2 * i] = corners[i].x + offset.x;
+		quad.corners[2 * i + 1] = corners[i].y + offset.y;
+	}
+	mOrder.push_back(make_pair(quad.texture, (uint)mQuads.size()));
+	mQuads.push_back(quad);
+}
+
+/** Group the quads by texture and lay out their vertices. Quads showing
+	the same texture keep the order they were added in. */
+void SpriteBatch::Build()
+{
+	PROFILE_SCOPE("SpriteBatch::Build");
+
+	sort(mOrder.begin(), mOrder.end());
+	uint n = (uint)mOrder.size();
+	if (mVertices.size() < n * 4 * VERTEX_FLOATS) mVertices.resize(n * 4 * VERTEX_FLOATS);
+	for (uint i = 0; i < n; i++) {
+		const Quad& quad = mQuads[mOrder[i].second];
+		if (mBatches.empty() || mBatches.back().texture != quad.texture) {
+			Batch batch = { quad.texture, i, 0 };
+			mBatches.push_back(batch);
+		}
+		mBatches.back().count++;
+		GLfloat* vertex = &mVertices[i * 4 * VERTEX_FLOATS];
+		for (uint j = 0; j < 4; j++) {
+			vertex[0] = quad.corners[2 * j];
+			vertex[1] = quad.corners[2 * j + 1];
+			vertex[2] = TEX_COORDS[2 * j];
+			vertex[3] = TEX_COORDS[2 * j + 1];
+			vertex += VERTEX_FLOATS;
+		}
+	}
+}
+
+/** Draw the sprites laid out by the last Build(), one draw call per
+	texture. */
+void SpriteBatch::Render(void)
+{
+	if (mBatches.empty()) return;
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_BLEND);
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, VERTEX_FLOATS * sizeof(GLfloat), &mVertices[0]);
+	glTexCoordPointer(2, GL_FLOAT, VERTEX_FLOATS * sizeof(GLfloat), &mVertices[2]);
+	for (uint b = 0; b < mBatches.size(); b++) {
+		const Batch& batch = mBatches[b];
+		glBindTexture(GL_TEXTURE_2D, batch.texture);
+		glDrawArrays(GL_QUADS, batch.first * 4, batch.count * 4);
+	}
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisable(GL_BLEND);
+	glDisable(GL_TEXTURE_2D);
+}
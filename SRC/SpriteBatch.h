@@ -0,0 +1,53 @@
+#ifndef __SPRITEBATCH_H__
+#define __SPRITEBATCH_H__
+
+#include "GameUtil.h"
+
+class GameObject;
+
+// Sprites drawn together rather than object by object. Every sprite
+// added is laid out as a quad in world space by the object's transform
+// matrix, and the quads are grouped by the texture of the frame
+// they show, so all the sprites showing one frame are drawn with a single
+// draw call. Sprites showing the same frame may be drawn in any order
+// among themselves, so batched sprites should be ones that don't mind
+// overlapping each other, like asteroids.
+class SpriteBatch
+{
+public:
+	SpriteBatch();
+	~SpriteBatch();
+
+	void Clear();
+	void Add(GameObject* object, const GLVector3f& offset);
+	void Build();
+	void Render(void);
+
+	uint GetNumSprites() const { return (uint)mQuads.size(); }
+	uint GetNumBatches() const { return (uint)mBatches.size(); }
+
+private:
+	// The corners of one sprite's quad, and the texture it shows
+	struct Quad
+	{
+		uint texture;
+		GLfloat corners[8];
+	};
+
+	// A run of quads drawn with the same texture
+	struct Batch
+	{
+		uint texture;
+		uint first;
+		uint count;
+	};
+
+	vector<Quad> mQuads;
+	// Texture and position of each quad, sorted to group the quads
+	vector< pair<uint, uint> > mOrder;
+	// Position and texture coordinates of each corner, interleaved
+	vector<GLfloat> mVertices;
+	vector<Batch> mBatches;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include "TraceRecorder.h"
+
+using namespace std;
+
+atomic<bool> TraceRecorder::mEnabled(false);
+
+// Index of the calling thread in the recorder's thread list, or -1 if the
+// thread has not recorded anything yet
+static thread_local int sThreadIndex = -1;
+
+/** Write a string as a quoted JSON string. */
+static void WriteJsonString(ostream& out, const string& s)
+{
+	out << '"';
+	for (string::const_iterator it = s.begin(); it != s.end(); ++it) {
+		if (*it == '"' || *it == '\\') out << '\\';
+		out << *it;
+	}
+	out << '"';
+}
+
+// PRIVATE INSTANCE CONSTRUCTORS //////////////////////////////////////////////
+
+/** Constructor. Keeps the last ten seconds by default. */
+TraceRecorder::TraceRecorder(void)
+	: mWindow(10000000.0),
+	  mEpoch(chrono::high_resolution_clock::now())
+{
+}
+
+// PUBLIC INSTANCE METHODS ////////////////////////////////////////////////////
+
+/** Set the name shown for the calling thread's track. */
+void TraceRecorder::SetThreadName(const string& name)
+{
+	uint index = GetThreadIndex();
+	lock_guard<mutex> lock(mMutex);
+	mThreadNames[index] = name;
+}
+
+/** Get the time in microseconds since the recorder was created. */
+double TraceRecorder::GetTime(void) const
+{
+	return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - mEpoch).count();
+}
+
+/** Record a span on the calling thread from start until now. */
+void TraceRecorder::AddSpan(const char* name, double start)
+{
+	TraceEvent e;
+	e.name = name;
+	e.phase = 'X';
+	e.thread = GetThreadIndex();
+	e.timestamp = start;
+	e.duration = GetTime() - start;
+	e.value = 0;
+	AddEvent(e);
+}
+
+/** Record a sample on the named counter track. */
+void TraceRecorder::AddCounter(const char* name, double value)
+{
+	TraceEvent e;
+	e.name = name;
+	e.phase = 'C';
+	e.thread = GetThreadIndex();
+	e.timestamp = GetTime();
+	e.duration = 0;
+	e.value = value;
+	AddEvent(e);
+}
+
+/** Write the recorded history as Chrome trace event JSON, which can be
+	opened in chrome://tracing or ui.perfetto.dev. */
+bool TraceRecorder::Write(const string& filename)
+{
+	ofstream file(filename.c_str());
+	if (!file.is_open()) {
+		cerr << "Error writing trace " << filename << endl;
+		return false;
+	}
+
+	lock_guard<mutex> lock(mMutex);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (uint i = 0; i < mThreadNames.size(); i++) {
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+		WriteJsonString(file, mThreadNames[i]);
+		file << "}},\n";
+	}
+	char line[256];
+	for (deque<TraceEvent>::const_iterator it = mEvents.begin(); it != mEvents.end(); ++it) {
+		if (it->phase == 'X') {
+			snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+				it->name, it->thread, it->timestamp, it->duration);
+		} else {
+			snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%g}},\n",
+				it->name, it->thread, it->timestamp, it->value);
+		}
+		file << line;
+	}
+	// Finish with an empty metadata event so every real event can end with a comma
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Asteroids\"}}\n]}\n";
+	return true;
+}
+
+/** Write the trace to the given file when the program exits. */
+void TraceRecorder::WriteOnExit(const string& filename)
+{
+	if (mExitFilename.empty()) atexit(WriteAtExit);
+	mExitFilename = filename;
+}
+
+// PRIVATE INSTANCE METHODS ///////////////////////////////////////////////////
+
+/** Get the calling thread's index, registering it on first use. */
+uint TraceRecorder::GetThreadIndex(void)
+{
+	if (sThreadIndex < 0) {
+		lock_guard<mutex> lock(mMutex);
+		sThreadIndex = (int)mThreadNames.size();
+		char name[32];
+		snprintf(name, sizeof(name), "Thread %d", sThreadIndex);
+		mThreadNames.push_back(name);
+	}
+	return (uint)sThreadIndex;
+}
+
+/** Store an event and drop anything older than the history window. */
+void TraceRecorder::AddEvent(const TraceEvent& e)
+{
+	lock_guard<mutex> lock(mMutex);
+	mEvents.push_back(e);
+	double oldest = e.timestamp + e.duration - mWindow;
+	while (!mEvents.empty() && mEvents.front().timestamp + mEvents.front().duration < oldest) {
+		mEvents.pop_front();
+	}
+}
+
+/** Handler registered with atexit() by WriteOnExit(). */
+void TraceRecorder::WriteAtExit(void)
+{
+	TraceRecorder& recorder = GetInstance();
+	if (!recorder.mExitFilename.empty()) recorder.Write(recorder.mExitFilename);
+}
@@ -0,0 +1,72 @@
+#ifndef __TRACERECORDER_H__
+#define __TRACERECORDER_H__
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+
+// A span or counter sample. Times are in microseconds since the recorder
+// was created, as expected by the Chrome trace event format.
+struct TraceEvent
+{
+	const char* name;
+	// 'X' for a complete span, 'C' for a counter sample
+	char phase;
+	uint thread;
+	double timestamp;
+	double duration;
+	double value;
+};
+
+class TraceRecorder
+{
+public:
+	inline static TraceRecorder& GetInstance(void)
+	{
+		static TraceRecorder mInstance;
+		return mInstance;
+	}
+
+	inline static bool IsEnabled(void) { return mEnabled.load(std::memory_order_relaxed); }
+	void SetEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+
+	void SetWindowSeconds(double seconds) { mWindow = seconds * 1000000.0; }
+	double GetWindowSeconds() const { return mWindow / 1000000.0; }
+
+	void SetThreadName(const std::string& name);
+
+	double GetTime(void) const;
+	void AddSpan(const char* name, double start);
+	void AddCounter(const char* name, double value);
+
+	bool Write(const std::string& filename);
+	void WriteOnExit(const std::string& filename);
+
+private:
+	TraceRecorder(void);
+	~TraceRecorder(void) {}
+
+	uint GetThreadIndex(void);
+	void AddEvent(const TraceEvent& e);
+
+	static void WriteAtExit(void);
+
+	std::mutex mMutex;
+	std::deque<TraceEvent> mEvents;
+	std::vector<std::string> mThreadNames;
+	std::string mExitFilename;
+
+	// Length of history kept, in microseconds
+	double mWindow;
+	std::chrono::high_resolution_clock::time_point mEpoch;
+
+	// Checked by every thread before recording an event
+	static std::atomic<bool> mEnabled;
+};
+
+#endif
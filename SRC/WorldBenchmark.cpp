@@ -0,0 +1,424 @@
+// Headless benchmark of GameWorld update, collision and removal costs.
+//
+// Builds worlds of real Asteroid, Bullet and Explosion objects with
+// BoundingSphere collision shapes, steps each one for a fixed number of
+// ticks and reports the cost of each pass in nanoseconds per object per
+// tick. No window or GL context is created.
+//
+// In builds with TRACK_ALLOCATIONS defined it also counts heap allocations
+// per tick once the world has warmed up, and exits with status 2 if the
+// average exceeds the budget given with --alloc-budget.
+//
+// Usage: WorldBenchmark [options]
+//   --sizes <n,n,...>        object counts to run (default 100,1000,10000,50000)
+//   --mix <a,b,e>            percentage of asteroids, bullets and explosions
+//                            (default 70,20,10)
+//   --ticks <n>              ticks to run per world (default 100)
+//   --tick-millis <ms>       simulated time per tick (default 16)
+//   --seed <n>               random seed (default 1)
+//   --max-collision <n>      skip the collision pass above this many objects
+//                            (default 100000)
+//   --threads <n>            threads to update objects and test collisions
+//                            on, 0 for one per core (default 1)
+//   --view <n>               side of the square view at the world's centre;
+//                            regions away from it update less often
+//                            (default 0, the whole world)
+//   --far <n>                distance from the view beyond which objects
+//                            are far and don't collide (default 0, none)
+//   --particles <n>          also time the particle system on its own with
+//                            this many live particles (default 0, off)
+//   --fragment-wave <n>      also time this many pooled asteroids breaking
+//                            into two pieces each in one tick (default 0, off)
+//   --warmup-ticks <n>       ticks before allocations are counted (default 10)
+//   --alloc-budget <n>       fail if any world averages more allocations per
+//                            tick than this after warm up
+//   --csv                    print results as CSV
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include "GameUtil.h"
+#include "AllocationTracker.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "Animation.h"
+#include "Asteroid.h"
+#include "Bullet.h"
+#include "Explosion.h"
+#include "BoundingSphere.h"
+#include "ParticleSystem.h"
+#include "GameObjectPool.h"
+
+typedef chrono::high_resolution_clock Clock;
+
+// Accumulated time spent in each pass over a benchmark run
+struct BenchmarkTimes
+{
+	BenchmarkTimes()
+		: object_ticks(0), update(0), collision(0), removal(0), alloc_ticks(0), allocations(0), alloc_bytes(0) {}
+
+	// Sum of the live object count at the start of every tick
+	double object_ticks;
+	double update;
+	double collision;
+	double removal;
+
+	// Allocations counted over the ticks after warm up
+	uint alloc_ticks;
+	double allocations;
+	double alloc_bytes;
+	vector<AllocationCount> alloc_scopes;
+};
+
+// Options that control which worlds are built and how they are stepped
+struct BenchmarkOptions
+{
+	BenchmarkOptions()
+		: ticks(100), tick_millis(16), seed(1), max_collision(100000), threads(1), view(0), far(0), particles(0), fragment_wave(0), warmup_ticks(10), alloc_budget(-1), csv(false)
+	{
+		sizes.push_back(100);
+		sizes.push_back(1000);
+		sizes.push_back(10000);
+		sizes.push_back(50000);
+		mix[0] = 70;
+		mix[1] = 20;
+		mix[2] = 10;
+	}
+
+	vector<uint> sizes;
+	uint mix[3];
+	uint ticks;
+	int tick_millis;
+	uint seed;
+	uint max_collision;
+	uint threads;
+	float view;
+	float far;
+	uint particles;
+	uint fragment_wave;
+	uint warmup_ticks;
+	// Maximum average allocations per tick, or negative for no budget
+	double alloc_budget;
+	bool csv;
+};
+
+/** A world that times each pass of its update separately. */
+class BenchmarkWorld : public GameWorld
+{
+public:
+	void TimedUpdate(int t, bool collide, bool count_allocations, BenchmarkTimes& times)
+	{
+		times.object_ticks += mGameObjects.size();
+		// Drop anything the benchmark itself allocated since the last tick
+		AllocationTracker::GetInstance().NewFrame();
+
+		Clock::time_point t0 = Clock::now();
+		UpdateObjects(t);
+		Clock::time_point t1 = Clock::now();
+		if (collide) UpdateCollisions();
+		Clock::time_point t2 = Clock::now();
+		RemoveFlaggedObjects();
+		Clock::time_point t3 = Clock::now();
+
+		FireWorldUpdated();
+		FinishStats();
+		AllocationTracker::GetInstance().NewFrame();
+
+		times.update += chrono::duration<double, nano>(t1 - t0).count();
+		times.collision += chrono::duration<double, nano>(t2 - t1).count();
+		times.removal += chrono::duration<double, nano>(t3 - t2).count();
+		if (count_allocations) AddAllocations(times);
+	}
+
+private:
+	/** Add the allocations from the last tick to the totals. */
+	void AddAllocations(BenchmarkTimes& times)
+	{
+		const AllocationFrame& frame = AllocationTracker::GetInstance().GetLastFrame();
+		times.alloc_ticks++;
+		times.allocations += frame.allocations;
+		times.alloc_bytes += frame.bytes;
+		for (uint i = 0; i < frame.scopes.size(); i++) {
+			uint j = 0;
+			while (j < times.alloc_scopes.size() && times.alloc_scopes[j].scope != frame.scopes[i].scope) j++;
+			if (j == times.alloc_scopes.size()) {
+				AllocationCount count = { frame.scopes[i].scope, 0, 0 };
+				times.alloc_scopes.push_back(count);
+			}
+			times.alloc_scopes[j].allocations += frame.scopes[i].allocations;
+			times.alloc_scopes[j].bytes += frame.scopes[i].bytes;
+		}
+	}
+};
+
+// Stand-in for the explosion animation; frames are never drawn
+static uint explosion_frames[16] = { 0 };
+static Animation explosion_animation(64, 64, explosion_frames, 16);
+
+/** Fill a world with the given number of objects in the given mix. The
+	world is sized to keep the same density of objects at every size. */
+static void PopulateWorld(BenchmarkWorld& world, uint num_objects, const BenchmarkOptions& options)
+{
+	int size = (int)sqrt(num_objects * 1000.0);
+	if (size < 200) size = 200;
+	world.SetWidth(size);
+	world.SetHeight(size);
+	if (options.view > 0) world.SetView(GLVector3f(0, 0, 0), options.view, options.view);
+	world.SetSimulationDistances(0, options.far);
+
+	mt19937 random(options.seed);
+	uniform_real_distribution<float> position(-size / 2.0f, size / 2.0f);
+	uniform_real_distribution<float> angle(0, 360);
+	// Spread bullet lifetimes so removals happen throughout the run
+	uniform_int_distribution<int> ttl(1, 2 * options.ticks * options.tick_millis);
+
+	uint total = options.mix[0] + options.mix[1] + options.mix[2];
+	uint num_asteroids = num_objects * options.mix[0] / total;
+	uint num_bullets = num_objects * options.mix[1] / total;
+	uint num_explosions = num_objects - num_asteroids - num_bullets;
+
+	for (uint i = 0; i < num_asteroids; i++) {
+		shared_ptr<GameObject> asteroid = make_shared<Asteroid>(GLVector3f(position(random), position(random), 0), angle(random));
+		asteroid->SetBoundingShape(make_shared<BoundingSphere>(asteroid->GetThisPtr(), 10.0f));
+		world.AddObject(asteroid);
+	}
+	for (uint i = 0; i < num_bullets; i++) {
+		float a = angle(random);
+		GLVector3f v(30 * cos(DEG2RAD * a), 30 * sin(DEG2RAD * a), 0);
+		shared_ptr<GameObject> bullet = make_shared<Bullet>(GLVector3f(position(random), position(random), 0), v, GLVector3f(0, 0, 0), a, 0, ttl(random));
+		bullet->SetBoundingShape(make_shared<BoundingSphere>(bullet->GetThisPtr(), 2.0f));
+		world.AddObject(bullet);
+	}
+	for (uint i = 0; i < num_explosions; i++) {
+		shared_ptr<Sprite> sprite = make_shared<Sprite>(64, 64, &explosion_animation);
+		sprite->SetLoopAnimation(false);
+		sprite->SetClocked(true);
+		shared_ptr<GameObject> explosion = make_shared<Explosion>(GLVector3f(position(random), position(random), 0), GLVector3f(0, 0, 0), angle(random), 0);
+		explosion->SetSprite(sprite);
+		world.AddObject(explosion);
+	}
+}
+
+/** Time the particle system on its own, keeping the given number of
+	particles alive by replacing those that die, and print the cost of
+	updating each particle, to compare with the cost of an object. */
+static void BenchmarkParticles(uint num_particles, const BenchmarkOptions& options)
+{
+	GameWorld world;
+	world.SetWidth(1000);
+	world.SetHeight(1000);
+	ParticleSystem particles;
+	shared_ptr<ParticleEmitter> emitter = make_shared<ParticleEmitter>();
+	emitter->count = 100;
+	emitter->min_speed = 5;
+	emitter->max_speed = 40;
+	emitter->min_life = 0.5f;
+	emitter->max_life = 2.0f;
+	emitter->drag = 0.5f;
+	emitter->max_particles = num_particles;
+
+	mt19937 random(options.seed);
+	uniform_real_distribution<float> position(-500, 500);
+	double particle_ticks = 0;
+	double elapsed = 0;
+	for (uint tick = 0; tick < options.ticks; tick++) {
+		while (particles.GetNumParticles() + emitter->count <= num_particles) {
+			ParticleBurst burst = { emitter, GLVector3f(position(random), position(random), 0), GLVector3f(0, 0, 0), 0, emitter->count };
+			particles.Emit(burst);
+		}
+		particle_ticks += particles.GetNumParticles();
+		Clock::time_point t0 = Clock::now();
+		particles.Update(options.tick_millis, world);
+		elapsed += chrono::duration<double, nano>(Clock::now() - t0).count();
+	}
+	printf("%10u particles %12.2f ns/particle/tick\n", num_particles, elapsed / max(particle_ticks, 1.0));
+}
+
+/** Time a wave of pooled asteroids all breaking up in the same tick: each
+	is removed from the world and two pieces taken from the pool in its
+	place, and the pieces are added to the world in one batch. Prints the
+	cost and allocations of each piece, to check that waves of thousands of
+	pieces don't make the frame they happen in stand out. */
+static void BenchmarkFragmentWave(uint num_asteroids, const BenchmarkOptions& options)
+{
+	GameWorld world;
+	int size = max((int)sqrt(num_asteroids * 3000.0), 200);
+	world.SetWidth(size);
+	world.SetHeight(size);
+	GameObjectPool<Asteroid> pool([] {
+		Asteroid* asteroid = new Asteroid();
+		asteroid->SetBoundingShape(make_shared<BoundingSphere>());
+		return asteroid;
+	});
+	pool.Reserve(num_asteroids * 3);
+
+	mt19937 random(options.seed);
+	uniform_real_distribution<float> position(-size / 2.0f, size / 2.0f);
+	uniform_real_distribution<float> angle(0, 360);
+	vector< shared_ptr<GameObject> > asteroids;
+	pool.Acquire(num_asteroids, asteroids);
+	for (uint i = 0; i < num_asteroids; i++) {
+		Asteroid* asteroid = static_cast<Asteroid*>(asteroids[i].get());
+		asteroid->Launch(GLVector3f(position(random), position(random), 0), angle(random), 10, Asteroid::MAX_SIZE);
+		static_cast<BoundingSphere*>(asteroid->GetBoundingShape().get())->SetRadius(Asteroid::GetRadiusForSize(Asteroid::MAX_SIZE));
+	}
+	world.AddObjects(&asteroids[0], num_asteroids);
+	world.Update(options.tick_millis);
+
+	vector< shared_ptr<GameObject> > fragments;
+	fragments.reserve(num_asteroids * 2);
+	AllocationTracker::GetInstance().NewFrame();
+	Clock::time_point t0 = Clock::now();
+	for (uint i = 0; i < num_asteroids; i++) {
+		Asteroid* asteroid = static_cast<Asteroid*>(asteroids[i].get());
+		world.RemoveObject(asteroids[i]);
+		uint first = (uint)fragments.size();
+		pool.Acquire(2, fragments);
+		for (uint j = 0; j < 2; j++) {
+			Asteroid* fragment = static_cast<Asteroid*>(fragments[first + j].get());
+			fragment->Launch(asteroid->GetPosition(), asteroid->GetAngle() + 90 + 180 * j, 15, Asteroid::MAX_SIZE - 1);
+			static_cast<BoundingSphere*>(fragment->GetBoundingShape().get())->SetRadius(Asteroid::GetRadiusForSize(Asteroid::MAX_SIZE - 1));
+		}
+	}
+	asteroids.clear();
+	world.AddObjects(&fragments[0], (uint)fragments.size());
+	double elapsed = chrono::duration<double, nano>(Clock::now() - t0).count();
+	AllocationTracker::GetInstance().NewFrame();
+
+	const AllocationFrame& frame = AllocationTracker::GetInstance().GetLastFrame();
+	printf("%10u asteroids into %u pieces %10.2f ms %10.2f ns/piece", num_asteroids, (uint)fragments.size(),
+		elapsed / 1e6, elapsed / fragments.size());
+	if (AllocationTracker::IsAvailable()) printf(" %10.2f allocs/piece", (double)frame.allocations / fragments.size());
+	printf("\n");
+}
+
+/** Parse a comma separated list of numbers. */
+static vector<uint> ParseList(const char* s)
+{
+	vector<uint> values;
+	istringstream in(s);
+	string item;
+	while (getline(in, item, ',')) values.push_back((uint)atoi(item.c_str()));
+	return values;
+}
+
+/** Parse command line options, returning false on an unknown option. */
+static bool ParseOptions(int argc, char* argv[], BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--sizes" && has_value) {
+			options.sizes = ParseList(argv[++i]);
+		} else if (arg == "--mix" && has_value) {
+			vector<uint> mix = ParseList(argv[++i]);
+			if (mix.size() != 3 || mix[0] + mix[1] + mix[2] == 0) return false;
+			for (uint j = 0; j < 3; j++) options.mix[j] = mix[j];
+		} else if (arg == "--ticks" && has_value) {
+			options.ticks = (uint)atoi(argv[++i]);
+		} else if (arg == "--tick-millis" && has_value) {
+			options.tick_millis = atoi(argv[++i]);
+		} else if (arg == "--seed" && has_value) {
+			options.seed = (uint)atoi(argv[++i]);
+		} else if (arg == "--max-collision" && has_value) {
+			options.max_collision = (uint)atoi(argv[++i]);
+		} else if (arg == "--threads" && has_value) {
+			options.threads = (uint)atoi(argv[++i]);
+		} else if (arg == "--view" && has_value) {
+			options.view = (float)atof(argv[++i]);
+		} else if (arg == "--far" && has_value) {
+			options.far = (float)atof(argv[++i]);
+		} else if (arg == "--particles" && has_value) {
+			options.particles = (uint)atoi(argv[++i]);
+		} else if (arg == "--fragment-wave" && has_value) {
+			options.fragment_wave = (uint)atoi(argv[++i]);
+		} else if (arg == "--warmup-ticks" && has_value) {
+			options.warmup_ticks = (uint)atoi(argv[++i]);
+		} else if (arg == "--alloc-budget" && has_value) {
+			options.alloc_budget = atof(argv[++i]);
+		} else if (arg == "--csv") {
+			options.csv = true;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		cerr << "Usage: WorldBenchmark [--sizes n,n,...] [--mix a,b,e] [--ticks n] [--tick-millis ms]"
+			" [--seed n] [--max-collision n] [--threads n] [--view n] [--far n] [--particles n] [--fragment-wave n] [--warmup-ticks n] [--alloc-budget n] [--csv]" << endl;
+		return 1;
+	}
+
+	bool track_allocations = AllocationTracker::IsAvailable();
+	if (options.alloc_budget >= 0 && !track_allocations) {
+		cerr << "--alloc-budget needs a build with TRACK_ALLOCATIONS defined" << endl;
+		return 1;
+	}
+	AllocationTracker::GetInstance().SetEnabled(track_allocations);
+	bool over_budget = false;
+
+	if (options.csv) {
+		printf("objects,asteroids_pct,bullets_pct,explosions_pct,ticks,update_ns,collision_ns,removal_ns,total_ns,allocs_per_tick,alloc_bytes_per_tick\n");
+	} else {
+		printf("Mix %u%% asteroids, %u%% bullets, %u%% explosions; %u ticks of %d ms; %u worker threads\n",
+			options.mix[0], options.mix[1], options.mix[2], options.ticks, options.tick_millis, options.threads);
+		printf("%10s %12s %12s %12s %12s   (ns/object/tick)%s\n", "objects", "update", "collision", "removal", "total",
+			track_allocations ? "   allocs/tick" : "");
+	}
+
+	for (uint i = 0; i < options.sizes.size(); i++) {
+		uint num_objects = options.sizes[i];
+		bool collide = num_objects <= options.max_collision;
+
+		BenchmarkWorld world;
+		world.SetWorkerThreads(options.threads);
+		PopulateWorld(world, num_objects, options);
+		BenchmarkTimes times;
+		for (uint tick = 0; tick < options.ticks; tick++) {
+			world.TimedUpdate(options.tick_millis, collide, track_allocations && tick >= options.warmup_ticks, times);
+		}
+
+		double n = times.object_ticks > 0 ? times.object_ticks : 1;
+		double update = times.update / n;
+		double collision = times.collision / n;
+		double removal = times.removal / n;
+		double alloc_ticks = times.alloc_ticks > 0 ? times.alloc_ticks : 1;
+		double allocations = times.allocations / alloc_ticks;
+		double alloc_bytes = times.alloc_bytes / alloc_ticks;
+		char alloc_text[64] = "";
+		if (options.csv) {
+			if (times.alloc_ticks > 0) snprintf(alloc_text, sizeof(alloc_text), "%.2f,%.2f", allocations, alloc_bytes);
+			else snprintf(alloc_text, sizeof(alloc_text), ",");
+			printf("%u,%u,%u,%u,%u,%.2f,%s,%.2f,%.2f,%s\n", num_objects, options.mix[0], options.mix[1], options.mix[2],
+				options.ticks, update, collide ? to_string(collision).c_str() : "", removal, update + collision + removal, alloc_text);
+		} else {
+			char collision_text[32];
+			if (collide) snprintf(collision_text, sizeof(collision_text), "%12.2f", collision);
+			else snprintf(collision_text, sizeof(collision_text), "%12s", "skipped");
+			if (times.alloc_ticks > 0) snprintf(alloc_text, sizeof(alloc_text), "                   %11.2f", allocations);
+			printf("%10u %12.2f %s %12.2f %12.2f%s\n", num_objects, update, collision_text, removal, update + collision + removal, alloc_text);
+			// Break allocations down by the scope that made them
+			for (uint j = 0; j < times.alloc_scopes.size(); j++) {
+				const AllocationCount& count = times.alloc_scopes[j];
+				printf("%10s %-40s %11.2f allocs %11.0f bytes /tick\n", "", count.scope,
+					count.allocations / alloc_ticks, count.bytes / alloc_ticks);
+			}
+		}
+		if (times.alloc_ticks > 0 && options.alloc_budget >= 0 && allocations > options.alloc_budget) {
+			fprintf(stderr, "%u objects: %.2f allocations per tick is over the budget of %.2f\n",
+				num_objects, allocations, options.alloc_budget);
+			over_budget = true;
+		}
+		fflush(stdout);
+	}
+
+	if (options.particles > 0) BenchmarkParticles(options.particles, options);
+	if (options.fragment_wave > 0) BenchmarkFragmentWave(options.fragment_wave, options);
+	return over_budget ? 2 : 0;
+}
@@ -0,0 +1,108 @@
+#ifndef __WORLDCOMMANDBUFFER_H__
+#define __WORLDCOMMANDBUFFER_H__
+
+#include <algorithm>
+#include <functional>
+#include "GameUtil.h"
+#include "ParticleSystem.h"
+
+class GameObject;
+
+// Changes to the world requested by objects while they update. Objects may
+// update on several threads at once, so rather than change the world
+// directly each thread records its changes in its own buffer, and the
+// world applies them all at a sync point once every object has updated.
+// Each command is tagged with the update order of the object that made
+// it, so merged buffers apply in the same order for any number of threads.
+struct WorldCommandBuffer
+{
+	template <typename T>
+	struct Command
+	{
+		// Update order of the object that made the command
+		uint order;
+		// Position of the command among those the object made
+		uint sequence;
+		T value;
+	};
+
+	void AddObject(uint order, const shared_ptr<GameObject>& object)
+	{
+		Command< shared_ptr<GameObject> > command = { order, (uint)spawns.size(), object };
+		spawns.push_back(command);
+	}
+
+	void FlagForRemoval(uint order, const weak_ptr<GameObject>& object)
+	{
+		Command< weak_ptr<GameObject> > command = { order, (uint)removals.size(), object };
+		removals.push_back(command);
+	}
+
+	void PostEvent(uint order, const function<void()>& event)
+	{
+		Command< function<void()> > command = { order, (uint)events.size(), event };
+		events.push_back(command);
+	}
+
+	void EmitParticles(uint order, const ParticleBurst& burst)
+	{
+		Command<ParticleBurst> command = { order, (uint)bursts.size(), burst };
+		bursts.push_back(command);
+	}
+
+	/** Move every command from another buffer to the end of this one. */
+	void Append(WorldCommandBuffer& other)
+	{
+		Append(spawns, other.spawns);
+		Append(removals, other.removals);
+		Append(events, other.events);
+		Append(bursts, other.bursts);
+	}
+
+	/** Sort the commands into update order. An object updates on a single
+		thread, so its commands keep their relative order from one buffer. */
+	void Sort()
+	{
+		Sort(spawns);
+		Sort(removals);
+		Sort(events);
+		Sort(bursts);
+	}
+
+	/** Remove every command, keeping the buffers' capacity. */
+	void Clear()
+	{
+		spawns.clear();
+		removals.clear();
+		events.clear();
+		bursts.clear();
+	}
+
+	bool empty() const { return spawns.empty() && removals.empty() && events.empty() && bursts.empty(); }
+
+	vector< Command< shared_ptr<GameObject> > > spawns;
+	vector< Command< weak_ptr<GameObject> > > removals;
+	vector< Command< function<void()> > > events;
+	vector< Command<ParticleBurst> > bursts;
+
+private:
+	template <typename T>
+	static void Append(vector< Command<T> >& to, vector< Command<T> >& from)
+	{
+		for (uint i = 0; i < from.size(); i++) {
+			from[i].sequence = (uint)to.size();
+			to.push_back(std::move(from[i]));
+		}
+		from.clear();
+	}
+
+	template <typename T>
+	static void Sort(vector< Command<T> >& commands)
+	{
+		sort(commands.begin(), commands.end(), [](const Command<T>& a, const Command<T>& b) {
+			return a.order != b.order ? a.order < b.order : a.sequence < b.sequence;
+		});
+	}
+};
+
+#endif